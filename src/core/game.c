@@ -6,7 +6,7 @@
 
 static void init( void );
 static void update( float );
-static void draw( float );
+static void draw( float, float );
 static void destroy( void );
 
 static SceneManager* sceneManager;
@@ -15,6 +15,11 @@ static SceneManager* sceneManager;
 // before the first call to update but after the engine has initialized itself
 static void init() {
     sceneManager = initScenes();
+
+    // update runs once per frame with the frame's delta. To update at a 
+    // steady 30Hz no matter the frame rate instead, catching up at most 4 
+    // updates after a slow frame:
+    // setFixedTimestep( 1.0f / 30.0f, 4 );
 }
 
 // update is your game's entry point to the engine
@@ -23,8 +28,9 @@ static void update( float delta ) {
 }
 
 // draw should be used to handle screen drawing operations. It is called after 
-// update
-static void draw( float delta ) {
+// update. alpha is how far, from 0 to 1, the frame is between the last update
+// and the next one when running with a fixed timestep
+static void draw( float delta, float alpha ) {
     sprites->updateAndDrawSprites();
     prismaticSceneManager->draw( sceneManager, delta );
     sys->drawFPS( 0, 0 );
@@ -5,7 +5,7 @@
 typedef struct Game {
 	void ( *update )( float );
 	void ( *init )( void );
-	void ( *draw )( float );
+	void ( *draw )( float, float );
 	void ( *destroy )( void );
 } Game;
 
@@ -4,7 +4,6 @@
 
 #include "../../prismatic/prismatic.h"
 #include "scenes.h"
-#include "splashscene.h"
 #include "titlescene.h"
 
 static void enter( Scene* self );
@@ -12,6 +11,7 @@ static void exitScene( Scene* self );
 static void update( Scene* self, float delta );
 static void draw( Scene* self, float delta );
 static void destroy( Scene* self );
+static bool load( Scene* self );
 
 static void playerUpdate( PrismSprite* self, float delta );
 
@@ -19,6 +19,9 @@ static void handleInput( float delta );
 
 const string PLAYSCENE_NAME = "PlayScene";
 
+// Times the map is loaded from scratch before the PlayScene gives up
+#define PLAYSCENE_MAP_ATTEMPTS 3
+
 typedef enum {
     kDefault = 0,
     kFloor = 1,
@@ -33,6 +36,8 @@ static PDButtons input_current;
 static PDButtons input_pressed;
 static PDButtons input_released;
 static LDtkTileMap* map;
+static LDtkLoadStage mapStage;
+static int mapAttempts;
 
 Scene* newPlayScene() {
 
@@ -54,24 +59,74 @@ Scene* newPlayScene() {
     playScene->draw = draw;
     playScene->destroy = destroy;
 
-    string* collision = sys->realloc( NULL, sizeof( string ) * 2 + 1 );
-    collision[0] = "Collision";
-    collision[1] = "Floor";
-    collision[2] = NULL;
+    /////////////////////////////////////////////////////////////////
+    // The map and player are loaded in steps by the load function //
+    // once the Scene is preloaded                                 //
+    /////////////////////////////////////////////////////////////////
+    playScene->load = load;
 
-    /////////////////////////////////
-    // Create map from LDTK export //
-    /////////////////////////////////
-    map = prismaticTileMap->new( "assets/maps/Level_0", 16, collision, NULL );
+    return playScene;
+
+}
+
+static bool load( Scene* self ) {
+
+    /////////////////////////////////////////////////////////////
+    // Create map from LDTK export, loading one step each call //
+    /////////////////////////////////////////////////////////////
     if( map == NULL ) {
-    	return NULL;
+
+        //////////////////////////////////////////////////////////////
+        // Without its map the Scene can't be played, stop loading. //
+        // Preloading it again starts a new round of attempts       //
+        //////////////////////////////////////////////////////////////
+        if( mapAttempts == PLAYSCENE_MAP_ATTEMPTS ) {
+            mapAttempts = 0;
+            self->loadState = SceneLoadState_Failed;
+            return false;
+        }
+
+        mapAttempts++;
+
+        string collision[3] = { "Collision", "Floor", NULL };
+
+        map = prismaticTileMap->newDeferred( "assets/maps/Level_0", 16, collision, NULL );
+        if( map == NULL ) {
+            prismaticLogger->errorf( "Could not create the PlayScene map, attempt %d of %d", mapAttempts, PLAYSCENE_MAP_ATTEMPTS );
+            return false;
+        }
+
+        mapStage = LDtkLoadStage_Json;
+
     }
 
-    /////////////////////////////////////
-    // Tag map collision layer Sprites //
-    /////////////////////////////////////
-    prismaticTileMap->tagCollision( map, "Collision", kWall );
-    prismaticTileMap->tagCollision( map, "Floor", kFloor );
+    if( mapStage != LDtkLoadStage_Done ) {
+
+        mapStage = prismaticTileMap->loadStep( map );
+
+        //////////////////////////////////////////////////
+        // Start the map over on the next step to retry //
+        //////////////////////////////////////////////////
+        if( mapStage == LDtkLoadStage_Failed ) {
+            prismaticLogger->errorf( "Could not load the PlayScene map, attempt %d of %d", mapAttempts, PLAYSCENE_MAP_ATTEMPTS );
+            prismaticTileMap->delete( map );
+            map = NULL;
+            return false;
+        }
+
+        if( mapStage == LDtkLoadStage_Done ) {
+
+            /////////////////////////////////////
+            // Tag map collision layer Sprites //
+            /////////////////////////////////////
+            prismaticTileMap->tagCollision( map, "Collision", kWall );
+            prismaticTileMap->tagCollision( map, "Floor", kFloor );
+
+        }
+
+        return false;
+
+    }
 
     /////////////////////////
     // Create a new Sprite //
@@ -79,7 +134,9 @@ Scene* newPlayScene() {
     string paths[1] = { "assets/images/entities/player/player" };
     player = prismaticSprite->newFromPath( paths, 1, 0 );
     if( player == NULL ) {
-    	return NULL;
+        prismaticLogger->error( "Could not create the PlayScene player" );
+        self->loadState = SceneLoadState_Failed;
+        return false;
     }
 
     ///////////////////////////////////////////////////////////////////
@@ -110,10 +167,7 @@ Scene* newPlayScene() {
     /////////////////////////////////
     prismaticScene->add( playScene, "player", player );
 
-    sys->realloc( collision, 0 );
-    collision = NULL;
-
-    return playScene;
+    return true;
 
 }
 
@@ -124,15 +178,10 @@ static void enter( Scene* self ) {
     ///////////////////////////////////////////
     // Add the map & collision to the screen //
     ///////////////////////////////////////////
-    prismaticTileMap->add( map );
-    prismaticTileMap->addCollision( map );
-
-    ///////////////////////////////////////////////////
-    // Remove Scenes we will never switch back to 	 //
-    ///////////////////////////////////////////////////
-    SplashScene splashScene = prismaticSceneManager->get( self->sceneManager, SPLASHSCENE_NAME );
-    prismaticSceneManager->remove( self->sceneManager, splashScene );
-    prismaticScene->delete( splashScene );
+    if( map != NULL ) {
+        prismaticTileMap->add( map );
+        prismaticTileMap->addCollision( map );
+    }
 
 }
 
@@ -140,8 +189,10 @@ static void exitScene( Scene* self ) {
 	///////////////////////////////////////
 	// Remove the map and its collisions //
 	///////////////////////////////////////
-	prismaticTileMap->removeCollision( map );
-	prismaticTileMap->remove( map );
+	if( map != NULL ) {
+		prismaticTileMap->removeCollision( map );
+		prismaticTileMap->remove( map );
+	}
 }
 
 static void update( Scene* self, float delta ) {
@@ -160,7 +211,12 @@ static void destroy( Scene* self ) {
 	////////////////////
 	// Delete the map //
 	////////////////////
-	prismaticTileMap->delete( map );
+	if( map != NULL ) {
+		prismaticTileMap->delete( map );
+		map = NULL;
+	}
+
+	mapAttempts = 0;
 }
 
 
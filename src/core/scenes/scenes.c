@@ -8,9 +8,6 @@
 #include "playscene.h"
 
 static SceneManager* sm;
-static SplashScene splashScene;
-static TitleScene titleScene;
-static PlayScene playScene;
 
 const string FONT_PATH_SYSTEM = "/System/Fonts/Asheville-Sans-14-Bold.pft";
 
@@ -18,18 +15,17 @@ const LCDFont* FONT_SYSTEM = NULL;
 
 SceneManager* initScenes() {
 
-	splashScene = newSplashScene();
-	titleScene = newTitleScene();
-	playScene = newPlayScene();
-
-	sm = prismaticSceneManager->new( splashScene );
+	sm = prismaticSceneManager->new( NULL );
 	if( sm == NULL ) {
 		prismaticLogger->error( "Could not initialize Scene Manager!" );
 		return NULL;
 	} 
 
-	prismaticSceneManager->add( sm, titleScene );
-	prismaticSceneManager->add( sm, playScene );
+	// Scenes are built the first time they are needed. The splash & title 
+	// screens are never returned to, so they are released once they exit.
+	prismaticSceneManager->registerScene( sm, SPLASHSCENE_NAME, newSplashScene, true );
+	prismaticSceneManager->registerScene( sm, TITLESCENE_NAME, newTitleScene, true );
+	prismaticSceneManager->registerScene( sm, PLAYSCENE_NAME, newPlayScene, false );
 
 	const char** err = NULL;
 	FONT_SYSTEM = graphics->loadFont( FONT_PATH_SYSTEM, err );
@@ -37,6 +33,8 @@ SceneManager* initScenes() {
 		prismaticLogger->errorf( "Could not load system font. err: %s", err );
 	}
 
+	prismaticSceneManager->changeSceneByName( sm, SPLASHSCENE_NAME );
+
 	return sm;
 
 }
\ No newline at end of file
@@ -3,6 +3,7 @@
 
 #include "titlescene.h"
 #include "splashscene.h"
+#include "playscene.h"
 #include "../../prismatic/prismatic.h"
 
 static void enter( Scene* self );
@@ -11,8 +12,7 @@ static void update( Scene* self, float delta );
 static void draw( Scene* self, float delta );
 static void destroy( Scene* self );
 
-static void transitionInComplete( PrismTransition* self );
-static void transitionOutComplete( PrismTransition* self );
+static bool splashScript( PrismCoroutine* co, float delta );
 
 const string SPLASHSCENE_NAME = "SplashScreen";
 
@@ -22,6 +22,7 @@ static PrismTransition* transitionIn;
 static PrismTransition* transitionOut;
 static PrismTransition* currentTransition;
 static FilePlayer* startupPlayer;
+static PrismCoroutine script;
 
 Scene* newSplashScene() {
 
@@ -40,7 +41,7 @@ Scene* newSplashScene() {
 	splashScene->draw = draw;
 	splashScene->destroy = destroy;
 
-	logo = graphics->loadBitmap( "assets/images/ui/logo", NULL );
+	logo = prismaticAssets->loadBitmap( "assets/images/ui/logo", NULL );
 	if( logo == NULL ) {
 		prismaticLogger->errorf( "%s: Could not load logo", SPLASHSCENE_NAME );
 	}
@@ -51,7 +52,6 @@ Scene* newSplashScene() {
 	}
 
 	transitionIn->completeDelay = 1.25f;
-	transitionIn->complete = transitionInComplete;
 
 	transitionOut = prismaticTransition->new( logo, 0, 0, 0.025f, PrismTransitionType_FadeOut );
 	if( transitionOut == NULL ) {
@@ -59,7 +59,6 @@ Scene* newSplashScene() {
 	}
 
 	transitionOut->completeDelay = 0.25f;
-	transitionOut->complete = transitionOutComplete;
 
 	currentTransition = transitionIn;
 
@@ -72,6 +71,10 @@ Scene* newSplashScene() {
 
 static void enter( Scene* self ) {
 	sound->fileplayer->play( startupPlayer, 1 );
+	prismaticScene->startCoroutine( self, &script, splashScript, NULL );
+
+	// Start loading the PlayScene while the logo is showing
+	prismaticSceneManager->preload( self->sceneManager, prismaticSceneManager->get( self->sceneManager, PLAYSCENE_NAME ) );
 }
 
 static void exitScene( Scene* self ) {}
@@ -85,16 +88,34 @@ static void draw( Scene* self, float delta ) {
 }
 
 static void destroy( Scene* self ) {
-	graphics->freeBitmap( logo );
+	prismaticAssets->release( logo );
 	sound->fileplayer->freePlayer( startupPlayer );
 	prismaticTransition->delete( transitionIn );
 	prismaticTransition->delete( transitionOut );
+
+	// The SceneManager releases this Scene after it exits, reset so 
+	// newSplashScene builds a fresh one if it is needed again
+	splashScene = NULL;
+	logo = NULL;
+	startupPlayer = NULL;
+	transitionIn = NULL;
+	transitionOut = NULL;
+	currentTransition = NULL;
 }
 
-static void transitionInComplete( PrismTransition* self ) {
+// Fade the logo in, hold it, fade it out, then move on to the TitleScene
+static bool splashScript( PrismCoroutine* co, float delta ) {
+
+	PRISM_CO_BEGIN( co );
+
+	currentTransition = transitionIn;
+	PRISM_CO_WAIT_FOR( co, transitionIn );
+
 	currentTransition = transitionOut;
-}
+	PRISM_CO_WAIT_FOR( co, transitionOut );
 
-static void transitionOutComplete( PrismTransition* self ) {
 	prismaticSceneManager->changeSceneByName( splashScene->sceneManager, TITLESCENE_NAME );
+
+	PRISM_CO_END( co );
+
 }
\ No newline at end of file
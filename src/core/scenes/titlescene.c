@@ -17,14 +17,20 @@ static void destroy( Scene* self );
 static void transitionComplete( PrismTransition* self );
 
 static void handleInput( float delta );
+static bool playSceneReady( void );
+static bool playSceneFailed( void );
 
 const string TITLESCENE_NAME = "TitleScene";
 static const string START_TEXT = "Press A or B to Start";
+static const string LOADING_TEXT = "Loading...";
+static const string FAILED_TEXT = "Could not load the game";
 
 Scene* newTitleScene( void );
 
 static Scene* titleScene;
 static int textWidth;
+static int loadingTextWidth;
+static int failedTextWidth;
 static uint8_t fontHeight;
 static PDButtons input_current;
 static PDButtons input_pressed;
@@ -61,6 +67,11 @@ Scene* newTitleScene() {
 static void enter( Scene* self ) {
 
 	textWidth = graphics->getTextWidth( FONT_SYSTEM, START_TEXT, strlen( START_TEXT ), kUTF8Encoding, graphics->getTextTracking() );
+	loadingTextWidth = graphics->getTextWidth( FONT_SYSTEM, LOADING_TEXT, strlen( LOADING_TEXT ), kUTF8Encoding, graphics->getTextTracking() );
+	failedTextWidth = graphics->getTextWidth( FONT_SYSTEM, FAILED_TEXT, strlen( FAILED_TEXT ), kUTF8Encoding, graphics->getTextTracking() );
+
+	// Usually already started by the splash screen, does nothing if so
+	prismaticSceneManager->preload( self->sceneManager, prismaticSceneManager->get( self->sceneManager, PLAYSCENE_NAME ) );
 	fontHeight = graphics->getFontHeight( FONT_SYSTEM );
 
 }
@@ -87,9 +98,25 @@ static void update( Scene* self, float delta ) {
 
 static void handleInput( float delta ) {
 	sys->getButtonState( &input_current, &input_pressed, &input_released );
+
+	// The PlayScene can only be started once it has finished loading
+	if( !playSceneReady() ) {
+		return;
+	}
+
 	startGame = ( input_pressed & kButtonA || input_pressed & kButtonB );
 }
 
+static bool playSceneReady( void ) {
+	Scene* playScene = prismaticSceneManager->get( titleScene->sceneManager, PLAYSCENE_NAME );
+	return playScene != NULL && prismaticScene->isReady( playScene );
+}
+
+static bool playSceneFailed( void ) {
+	Scene* playScene = prismaticSceneManager->get( titleScene->sceneManager, PLAYSCENE_NAME );
+	return playScene == NULL || playScene->loadState == SceneLoadState_Failed;
+}
+
 static void draw( Scene* self, float delta ) {
 	
 	if( startGame ) {
@@ -103,21 +130,44 @@ static void draw( Scene* self, float delta ) {
 	// Draw background overlay
 	graphics->fillRect( 0, 0, pd->display->getWidth(), pd->display->getHeight(), kColorBlack );
 
-	// Draw Start Text
+	// Draw Start Text, or Loading Text until the PlayScene is ready, or 
+	// Failed Text if it never will be
 	graphics->setDrawMode( kDrawModeInverted );
 	graphics->setFont( FONT_SYSTEM );
 
+	string text = START_TEXT;
+	int width = textWidth;
+
+	if( playSceneFailed() ) {
+		text = FAILED_TEXT;
+		width = failedTextWidth;
+	} else if( !playSceneReady() ) {
+		text = LOADING_TEXT;
+		width = loadingTextWidth;
+	}
+
 	graphics->drawText( 
-		START_TEXT, strlen( START_TEXT ), 
+		text, strlen( text ), 
 		kUTF8Encoding, 
-		( pd->display->getWidth() / 2 ) - ( textWidth / 2 ), 
+		( pd->display->getWidth() / 2 ) - ( width / 2 ), 
 		( pd->display->getHeight() / 2 ) - ( fontHeight / 2 )
 	);
 
 }
 
 static void destroy( Scene* self ) {
-	graphics->freeBitmap( screencap );
+	if( screencap != NULL ) {
+		graphics->freeBitmap( screencap );
+	}
+
+	prismaticTransition->delete( transitionOut );
+
+	// The SceneManager releases this Scene after it exits, reset so 
+	// newTitleScene builds a fresh one if it is needed again
+	titleScene = NULL;
+	screencap = NULL;
+	transitionOut = NULL;
+	startGame = false;
 }
 
 static void transitionComplete( PrismTransition* self ) {
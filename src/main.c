@@ -7,7 +7,8 @@
 #include "prismatic/prismatic.h"
 
 static int update(void* userdata);
-static int clock;
+static int initClock;
+static bool started = false;
 
 #ifdef _WINDLL
 __declspec(dllexport)
@@ -20,8 +21,9 @@ int eventHandler( PlaydateAPI* p, PDSystemEvent event, uint32_t arg ) {
 
 	if ( event == kEventInit ) {
 
-		// Initialize clock
-		clock = p->system->getCurrentTimeMilliseconds();
+		// Initialize clocks
+		initClock = p->system->getCurrentTimeMilliseconds();
+		p->system->resetElapsedTime();
 
 		// bootstrap Prismatic Engine
 		initEngine( p );
@@ -40,12 +42,17 @@ int eventHandler( PlaydateAPI* p, PDSystemEvent event, uint32_t arg ) {
 // Main game loop
 static int update( void* userdata ) {
 
-	int update = sys->getCurrentTimeMilliseconds();
-	float elapsed = (float)( update - clock );
-	float delta = elapsed / 1000.0f;
+	// Report cold start time, from kEventInit to the first frame
+	if( !started ) {
+		started = true;
+		prismaticLogger->infof( "Startup took %dms", sys->getCurrentTimeMilliseconds() - initClock );
+	}
+
+	// Sub-millisecond frame time, so a fixed timestep accumulates evenly
+	float delta = sys->getElapsedTime();
+	sys->resetElapsedTime();
 
 	updateEngine( delta );
-	clock = update;
 
 	return 1;
 
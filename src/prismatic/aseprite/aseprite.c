@@ -0,0 +1,589 @@
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "../prismatic.h"
+#include "aseprite.h"
+
+// Which of a frame's rects is being decoded
+typedef enum {
+	AsepriteRect_None,
+	// "frame" - Where the frame is on the sheet
+	AsepriteRect_Frame,
+	// "spriteSourceSize" - Where the trimmed frame sits in the untrimmed one
+	AsepriteRect_Trim,
+	// "sourceSize" - The size of the untrimmed frame
+	AsepriteRect_Source,
+} AsepriteRect;
+
+typedef enum {
+	AsepriteDirection_Forward,
+	AsepriteDirection_Reverse,
+	AsepriteDirection_PingPong,
+	AsepriteDirection_PingPongReverse,
+} AsepriteDirection;
+
+typedef struct AsepriteFrame {
+	int x;
+	int y;
+	int width;
+	int height;
+	int trimX;
+	int trimY;
+	int sourceWidth;
+	int sourceHeight;
+	// Milliseconds
+	int duration;
+} AsepriteFrame;
+
+typedef struct AsepriteTag {
+	string name;
+	int from;
+	int to;
+	AsepriteDirection direction;
+} AsepriteTag;
+
+// Everything read from the JSON, kept until the Sprite is built
+typedef struct AsepriteImport {
+	AsepriteFrame* frames;
+	size_t frameCount;
+	size_t _frameCapacity;
+	AsepriteTag* tags;
+	size_t tagCount;
+	size_t _tagCapacity;
+	// meta.image, as written by Aseprite
+	string image;
+	// Sublist nesting, and the depth the frames, meta and frameTags lists
+	// were opened at, 0 while they are not open
+	int depth;
+	int framesDepth;
+	int metaDepth;
+	int tagsDepth;
+	AsepriteRect rect;
+	bool failed;
+} AsepriteImport;
+
+static PrismSprite* newAsepriteSprite( string path );
+
+static bool decodeAsepriteJson( AsepriteImport* import, string path );
+static LCDBitmapTable* copyFrames( AsepriteImport* import, LCDBitmap* sheet );
+static void applyTimings( AsepriteImport* import, PrismAnimation* animation );
+static void addTagClip( AsepriteImport* import, AsepriteTag* tag, PrismAnimation* animation );
+static string sheetPathFor( string path, string image );
+static void freeImport( AsepriteImport* import );
+static int readfile( void* readud, uint8_t* buf, int bufsize );
+
+static void decodeError( json_decoder* decoder, const char* error, int linenum );
+static void willDecodeSublist( json_decoder* decoder, const char* name, json_value_type type );
+static int shouldDecodeTableValueForKey( json_decoder* decoder, const char* key );
+static void didDecodeTableValue( json_decoder* decoder, const char* key, json_value value );
+static int shouldDecodeArrayValueAtIndex( json_decoder* decoder, int pos );
+static void didDecodeArrayValue( json_decoder* decoder, int pos, json_value value );
+static void* didDecodeSublist( json_decoder* decoder, const char* name, json_value_type type );
+static void newFrame( AsepriteImport* import );
+static void newTag( AsepriteImport* import );
+static void decodeRect( AsepriteFrame* frame, AsepriteRect rect, const char* key, int value );
+static void decodeTag( AsepriteTag* tag, const char* key, json_value value );
+static AsepriteRect rectNamed( const char* name );
+static int numberValue( json_value value );
+
+static PrismSprite* newAsepriteSprite( string path ) {
+
+	if( path == NULL ) {
+		prismaticLogger->error( "Cannot load Aseprite export with NULL path" );
+		return NULL;
+	}
+
+	AsepriteImport import = { 0 };
+
+	if( !decodeAsepriteJson( &import, path ) ) {
+		freeImport( &import );
+		return NULL;
+	}
+
+	if( import.frameCount < 1 || import.image == NULL ) {
+		prismaticLogger->errorf( "Aseprite export '%s' has no frames or no sheet image", path );
+		freeImport( &import );
+		return NULL;
+	}
+
+	string sheetPath = sheetPathFor( path, import.image );
+	if( sheetPath == NULL ) {
+		prismaticLogger->error( "Could not allocate memory for Aseprite sheet path" );
+		freeImport( &import );
+		return NULL;
+	}
+
+	const char* err = NULL;
+
+	LCDBitmap* sheet = prismaticAssets->loadBitmap( sheetPath, &err );
+	if( sheet == NULL ) {
+		prismaticLogger->errorf( "Could not load Aseprite sheet '%s': %s", sheetPath, err != NULL ? err : "not found" );
+		prismaticString->delete( sheetPath );
+		freeImport( &import );
+		return NULL;
+	}
+
+	// The frames are copied into the table, the sheet is not needed after
+	LCDBitmapTable* table = copyFrames( &import, sheet );
+	prismaticAssets->release( sheet );
+
+	if( table == NULL ) {
+		prismaticLogger->errorf( "Could not copy frames of Aseprite sheet '%s'", sheetPath );
+		prismaticString->delete( sheetPath );
+		freeImport( &import );
+		return NULL;
+	}
+
+	prismaticString->delete( sheetPath );
+
+	PrismSprite* s = prismaticSprite->newFromBitmapTable( table, (float)import.frames[0].duration / 1000.0f );
+	if( s == NULL ) {
+		graphics->freeBitmapTable( table );
+		freeImport( &import );
+		return NULL;
+	}
+
+	if( s->animation != NULL ) {
+		applyTimings( &import, s->animation );
+	}
+
+	freeImport( &import );
+
+	return s;
+
+}
+
+static bool decodeAsepriteJson( AsepriteImport* import, string path ) {
+
+	SDFile* jsonFile = pd->file->open( path, kFileRead );
+	if( jsonFile == NULL ) {
+		prismaticLogger->errorf( "Failed to open JSON at path \"%s\"", path );
+		return false;
+	}
+
+	json_reader reader = {
+		.read = readfile,
+		.userdata = jsonFile,
+	};
+
+	json_decoder decoder = {
+		.decodeError = decodeError,
+		.shouldDecodeTableValueForKey = shouldDecodeTableValueForKey,
+		.didDecodeTableValue = didDecodeTableValue,
+		.willDecodeSublist = willDecodeSublist,
+		.shouldDecodeArrayValueAtIndex = shouldDecodeArrayValueAtIndex,
+		.didDecodeArrayValue = didDecodeArrayValue,
+		.didDecodeSublist = didDecodeSublist,
+		.userdata = import,
+	};
+
+	pd->json->decode( &decoder, reader, NULL );
+	pd->file->close( jsonFile );
+
+	return !import->failed;
+
+}
+
+// Draw each frame's rect of the sheet into a table cell the size of the
+// untrimmed frame, at the position it was trimmed from
+static LCDBitmapTable* copyFrames( AsepriteImport* import, LCDBitmap* sheet ) {
+
+	int cellWidth = 0, cellHeight = 0;
+
+	for( size_t i = 0; i < import->frameCount; i++ ) {
+
+		AsepriteFrame* frame = &import->frames[i];
+
+		int width = frame->sourceWidth > 0 ? frame->sourceWidth : frame->width;
+		int height = frame->sourceHeight > 0 ? frame->sourceHeight : frame->height;
+
+		cellWidth = width > cellWidth ? width : cellWidth;
+		cellHeight = height > cellHeight ? height : cellHeight;
+
+	}
+
+	if( cellWidth <= 0 || cellHeight <= 0 ) {
+		return NULL;
+	}
+
+	LCDBitmapTable* table = graphics->newBitmapTable( (int)import->frameCount, cellWidth, cellHeight );
+	if( table == NULL ) {
+		return NULL;
+	}
+
+	for( size_t i = 0; i < import->frameCount; i++ ) {
+
+		AsepriteFrame* frame = &import->frames[i];
+
+		graphics->pushContext( graphics->getTableBitmap( table, (int)i ) );
+		graphics->clear( kColorClear );
+		graphics->setClipRect( frame->trimX, frame->trimY, frame->width, frame->height );
+		graphics->drawBitmap( sheet, frame->trimX - frame->x, frame->trimY - frame->y, kBitmapUnflipped );
+		graphics->clearClipRect();
+		graphics->popContext();
+
+	}
+
+	return table;
+
+}
+
+static void applyTimings( AsepriteImport* import, PrismAnimation* animation ) {
+
+	float* durations = malloc( import->frameCount * sizeof( float ) );
+	if( durations == NULL ) {
+		prismaticLogger->error( "Could not allocate memory for Aseprite frame durations" );
+		return;
+	}
+
+	for( size_t i = 0; i < import->frameCount; i++ ) {
+		durations[i] = (float)import->frames[i].duration / 1000.0f;
+	}
+
+	prismaticAnimation->setDurations( animation, durations );
+	free( durations );
+
+	for( size_t i = 0; i < import->tagCount; i++ ) {
+		addTagClip( import, &import->tags[i], animation );
+	}
+
+}
+
+static void addTagClip( AsepriteImport* import, AsepriteTag* tag, PrismAnimation* animation ) {
+
+	if( tag->name == NULL || tag->from < 0 || tag->to < tag->from || (size_t)tag->to >= import->frameCount ) {
+		prismaticLogger->errorf( "Skipping Aseprite tag '%s' with frames %d-%d", tag->name != NULL ? tag->name : "", tag->from, tag->to );
+		return;
+	}
+
+	// Frame durations replace the clip's speed, this only matters if they are
+	// cleared later
+	float playSpeed = (float)import->frames[tag->from].duration / 1000.0f;
+
+	if( tag->direction == AsepriteDirection_Forward ) {
+		prismaticAnimation->addClip( animation, tag->name, (size_t)tag->from, (size_t)( tag->to - tag->from + 1 ), playSpeed, true );
+		return;
+	}
+
+	// Ping-pong plays both ends once per pass, e.g. 0 1 2 1 for 0-2
+	size_t length = (size_t)( tag->to - tag->from + 1 );
+	size_t count = length;
+
+	if( tag->direction != AsepriteDirection_Reverse && length > 2 ) {
+		count = length * 2 - 2;
+	}
+
+	size_t* sequence = malloc( count * sizeof( size_t ) );
+	if( sequence == NULL ) {
+		prismaticLogger->errorf( "Could not allocate memory for Aseprite tag '%s'", tag->name );
+		return;
+	}
+
+	bool reversed = tag->direction == AsepriteDirection_Reverse || tag->direction == AsepriteDirection_PingPongReverse;
+
+	for( size_t i = 0; i < count; i++ ) {
+
+		size_t step = i < length ? i : count - i;
+
+		sequence[i] = reversed ? (size_t)tag->to - step : (size_t)tag->from + step;
+
+	}
+
+	prismaticAnimation->addClipSequence( animation, tag->name, sequence, count, playSpeed, true );
+	free( sequence );
+
+}
+
+// The sheet's path, next to the JSON and without the image's extension
+static string sheetPathFor( string path, string image ) {
+
+	const char* slash = strrchr( path, '/' );
+	size_t directoryLength = slash != NULL ? (size_t)( slash - path ) + 1 : 0;
+
+	const char* dot = strrchr( image, '.' );
+	size_t imageLength = dot != NULL && strchr( dot, '/' ) == NULL ? (size_t)( dot - image ) : strlen( image );
+
+	string sheetPath = malloc( directoryLength + imageLength + 1 );
+	if( sheetPath == NULL ) {
+		return NULL;
+	}
+
+	memcpy( sheetPath, path, directoryLength );
+	memcpy( sheetPath + directoryLength, image, imageLength );
+	sheetPath[directoryLength + imageLength] = '\0';
+
+	return sheetPath;
+
+}
+
+static void freeImport( AsepriteImport* import ) {
+
+	for( size_t i = 0; i < import->tagCount; i++ ) {
+		prismaticString->delete( import->tags[i].name );
+	}
+
+	import->tags = prismaticArray->release( import->tags, &import->_tagCapacity );
+	import->frames = prismaticArray->release( import->frames, &import->_frameCapacity );
+	import->tagCount = 0;
+	import->frameCount = 0;
+
+	if( import->image != NULL ) {
+		prismaticString->delete( import->image );
+		import->image = NULL;
+	}
+
+}
+
+static int readfile( void* readud, uint8_t* buf, int bufsize ) {
+	return pd->file->read( (SDFile*)readud, buf, bufsize );
+}
+
+// JSON Parsing
+
+static void decodeError( json_decoder* decoder, const char* error, int linenum ) {
+
+	AsepriteImport* import = decoder->userdata;
+	import->failed = true;
+
+	prismaticLogger->errorf( "Error decoding Aseprite JSON: '%s' at line %d", error, linenum );
+
+}
+
+static void willDecodeSublist( json_decoder* decoder, const char* name, json_value_type type ) {
+
+	AsepriteImport* import = decoder->userdata;
+	import->depth++;
+
+	if( import->framesDepth == 0 && import->metaDepth == 0 ) {
+
+		if( strcmp( "frames", name ) == 0 ) {
+			import->framesDepth = import->depth;
+		} else if( strcmp( "meta", name ) == 0 ) {
+			import->metaDepth = import->depth;
+		}
+
+		return;
+
+	}
+
+	if( import->framesDepth > 0 ) {
+
+		// Each entry of frames is a frame, whether frames is an array or a hash
+		if( import->depth == import->framesDepth + 1 ) {
+			newFrame( import );
+		} else if( import->depth == import->framesDepth + 2 ) {
+			import->rect = rectNamed( name );
+		}
+
+		return;
+
+	}
+
+	if( import->tagsDepth == 0 && import->depth == import->metaDepth + 1 && strcmp( "frameTags", name ) == 0 ) {
+		import->tagsDepth = import->depth;
+		return;
+	}
+
+	if( import->tagsDepth > 0 && import->depth == import->tagsDepth + 1 ) {
+		newTag( import );
+	}
+
+}
+
+static int shouldDecodeTableValueForKey( json_decoder* decoder, const char* key ) {
+	return 1;
+}
+
+static void didDecodeTableValue( json_decoder* decoder, const char* key, json_value value ) {
+
+	AsepriteImport* import = decoder->userdata;
+
+	if( import->failed ) {
+		return;
+	}
+
+	if( import->framesDepth > 0 && import->frameCount > 0 ) {
+
+		AsepriteFrame* frame = &import->frames[import->frameCount - 1];
+
+		if( import->depth == import->framesDepth + 1 && strcmp( "duration", key ) == 0 ) {
+			frame->duration = numberValue( value );
+		} else if( import->depth == import->framesDepth + 2 ) {
+			decodeRect( frame, import->rect, key, numberValue( value ) );
+		}
+
+		return;
+
+	}
+
+	if( import->metaDepth > 0 && import->depth == import->metaDepth && strcmp( "image", key ) == 0 && value.type == kJSONString ) {
+		import->image = prismaticString->new( json_stringValue( value ) );
+		return;
+	}
+
+	if( import->tagsDepth > 0 && import->depth == import->tagsDepth + 1 && import->tagCount > 0 ) {
+		decodeTag( &import->tags[import->tagCount - 1], key, value );
+	}
+
+}
+
+static int shouldDecodeArrayValueAtIndex( json_decoder* decoder, int pos ) {
+	return 1;
+}
+
+static void didDecodeArrayValue( json_decoder* decoder, int pos, json_value value ) {
+
+}
+
+static void* didDecodeSublist( json_decoder* decoder, const char* name, json_value_type type ) {
+
+	AsepriteImport* import = decoder->userdata;
+
+	if( import->depth == import->framesDepth ) {
+		import->framesDepth = 0;
+	} else if( import->depth == import->metaDepth ) {
+		import->metaDepth = 0;
+	} else if( import->depth == import->tagsDepth ) {
+		import->tagsDepth = 0;
+	} else if( import->framesDepth > 0 && import->depth == import->framesDepth + 2 ) {
+		import->rect = AsepriteRect_None;
+	}
+
+	import->depth--;
+
+	return NULL;
+
+}
+
+static void newFrame( AsepriteImport* import ) {
+
+	AsepriteFrame* frames = prismaticArray->reserve( import->frames, &import->_frameCapacity, import->frameCount + 1, sizeof( AsepriteFrame ) );
+	if( frames == NULL ) {
+		prismaticLogger->error( "Memory allocation failed for Aseprite frame" );
+		import->failed = true;
+		return;
+	}
+
+	import->frames = frames;
+	memset( &import->frames[import->frameCount++], 0, sizeof( AsepriteFrame ) );
+
+}
+
+static void newTag( AsepriteImport* import ) {
+
+	AsepriteTag* tags = prismaticArray->reserve( import->tags, &import->_tagCapacity, import->tagCount + 1, sizeof( AsepriteTag ) );
+	if( tags == NULL ) {
+		prismaticLogger->error( "Memory allocation failed for Aseprite tag" );
+		import->failed = true;
+		return;
+	}
+
+	import->tags = tags;
+	memset( &import->tags[import->tagCount++], 0, sizeof( AsepriteTag ) );
+
+}
+
+static void decodeRect( AsepriteFrame* frame, AsepriteRect rect, const char* key, int value ) {
+
+	bool isX = strcmp( "x", key ) == 0;
+	bool isY = strcmp( "y", key ) == 0;
+	bool isW = strcmp( "w", key ) == 0;
+	bool isH = strcmp( "h", key ) == 0;
+
+	switch( rect ) {
+
+		case AsepriteRect_Frame:
+			if( isX ) frame->x = value;
+			if( isY ) frame->y = value;
+			if( isW ) frame->width = value;
+			if( isH ) frame->height = value;
+			break;
+
+		case AsepriteRect_Trim:
+			if( isX ) frame->trimX = value;
+			if( isY ) frame->trimY = value;
+			break;
+
+		case AsepriteRect_Source:
+			if( isW ) frame->sourceWidth = value;
+			if( isH ) frame->sourceHeight = value;
+			break;
+
+		default:
+			break;
+
+	}
+
+}
+
+static void decodeTag( AsepriteTag* tag, const char* key, json_value value ) {
+
+	if( strcmp( "name", key ) == 0 && value.type == kJSONString && tag->name == NULL ) {
+		tag->name = prismaticString->new( json_stringValue( value ) );
+		return;
+	}
+
+	if( strcmp( "from", key ) == 0 ) {
+		tag->from = numberValue( value );
+		return;
+	}
+
+	if( strcmp( "to", key ) == 0 ) {
+		tag->to = numberValue( value );
+		return;
+	}
+
+	if( strcmp( "direction", key ) == 0 && value.type == kJSONString ) {
+
+		string direction = json_stringValue( value );
+
+		if( strcmp( "reverse", direction ) == 0 ) {
+			tag->direction = AsepriteDirection_Reverse;
+		} else if( strcmp( "pingpong", direction ) == 0 ) {
+			tag->direction = AsepriteDirection_PingPong;
+		} else if( strcmp( "pingpong_reverse", direction ) == 0 ) {
+			tag->direction = AsepriteDirection_PingPongReverse;
+		} else {
+			tag->direction = AsepriteDirection_Forward;
+		}
+
+	}
+
+}
+
+static AsepriteRect rectNamed( const char* name ) {
+
+	if( strcmp( "frame", name ) == 0 ) {
+		return AsepriteRect_Frame;
+	}
+
+	if( strcmp( "spriteSourceSize", name ) == 0 ) {
+		return AsepriteRect_Trim;
+	}
+
+	if( strcmp( "sourceSize", name ) == 0 ) {
+		return AsepriteRect_Source;
+	}
+
+	return AsepriteRect_None;
+
+}
+
+static int numberValue( json_value value ) {
+
+	if( value.type == kJSONInteger ) {
+		return json_intValue( value );
+	}
+
+	if( value.type == kJSONFloat ) {
+		return (int)json_floatValue( value );
+	}
+
+	return 0;
+
+}
+
+const AsepriteFn* prismaticAseprite = &(AsepriteFn) {
+	.newSprite = newAsepriteSprite,
+};
@@ -0,0 +1,43 @@
+#ifndef ASEPRITE_H
+#define ASEPRITE_H
+
+#ifndef PD_API_INCLUDED
+	#define PD_API_INCLUDED
+	#include "pd_api.h"
+#endif
+
+#ifndef TEXT_INCLUDED
+	#define TEXT_INCLUDED
+	#include "../text/text.h"
+#endif
+
+#ifndef SPRITE_INCLUDED
+	#define SPRITE_INCLUDED
+	#include "../sprite/sprite.h"
+#endif
+
+typedef struct AsepriteFn {
+	// Create a Sprite from an Aseprite sprite sheet export
+	//
+	// Reads the JSON written by Aseprite's Export Sprite Sheet, with frames
+	// as an Array or a Hash, in one streaming pass. The sheet image named in
+	// meta.image is loaded from the JSON's directory and its frames are
+	// copied into a table owned by the Sprite, so trimmed and packed sheets
+	// work.
+	//
+	// If the export has more than one frame, the Sprite's Animation uses
+	// each frame's duration, and gets a looping clip for each tag, named
+	// after the tag and played in the tag's direction.
+	//
+	// Returns NULL if the JSON or the sheet could not be loaded.
+	//
+	// ----
+	//
+	// string path - Path to the JSON on the file system, including extension.
+	// e.g. "assets/images/player.json"
+	PrismSprite* ( *newSprite )( string );
+} AsepriteFn;
+
+extern const AsepriteFn* prismaticAseprite;
+
+#endif // ASEPRITE_H
@@ -0,0 +1,304 @@
+#include <stddef.h>
+#include <stdlib.h>
+
+#include "../prismatic.h"
+#include "assets.h"
+
+static LCDBitmap* loadBitmap( string path, const char** outErr );
+static bool retainBitmap( LCDBitmap* bitmap );
+static bool releaseBitmap( LCDBitmap* bitmap );
+static LCDBitmapTable* loadBitmapTable( string path, const char** outErr );
+static bool releaseTable( LCDBitmapTable* table );
+static size_t countAssets( void );
+static size_t residentBytes( void );
+static void logAssetStats( void );
+
+static PrismAsset* loadAsset( string path, bool isTable, const char** outErr );
+static bool releaseAsset( const void* handle, bool isTable );
+static void freeAsset( PrismAsset* asset );
+static PrismAsset* findAsset( const void* handle, bool isTable );
+static const char* assetHandle( PrismAsset* asset );
+static size_t bitmapBytes( LCDBitmap* bitmap );
+static size_t tableBytes( LCDBitmapTable* table );
+
+// Cached assets, in no particular order
+static PrismAsset** assets = NULL;
+static size_t assetCount = 0;
+static size_t assetCapacity = 0;
+
+// Path -> PrismAsset*, created on first load. Tables get their own index,
+// since a table and a bitmap can share a path.
+static PrismHashMap* bitmapIndex = NULL;
+static PrismHashMap* tableIndex = NULL;
+
+// Bitmap or table pointer -> PrismAsset*, keyed by address, so retain and 
+// release never scan the cache
+static PrismHashMap* handleIndex = NULL;
+
+static size_t totalBytes = 0;
+
+static LCDBitmap* loadBitmap( string path, const char** outErr ) {
+
+	PrismAsset* asset = loadAsset( path, false, outErr );
+
+	return asset != NULL ? asset->bitmap : NULL;
+
+}
+
+static bool retainBitmap( LCDBitmap* bitmap ) {
+
+	PrismAsset* asset = findAsset( bitmap, false );
+	if( asset == NULL ) {
+		return false;
+	}
+
+	asset->refs++;
+
+	return true;
+
+}
+
+static bool releaseBitmap( LCDBitmap* bitmap ) {
+	return releaseAsset( bitmap, false );
+}
+
+static LCDBitmapTable* loadBitmapTable( string path, const char** outErr ) {
+
+	PrismAsset* asset = loadAsset( path, true, outErr );
+
+	return asset != NULL ? asset->table : NULL;
+
+}
+
+static bool releaseTable( LCDBitmapTable* table ) {
+	return releaseAsset( table, true );
+}
+
+static size_t countAssets( void ) {
+	return assetCount;
+}
+
+static size_t residentBytes( void ) {
+	return totalBytes;
+}
+
+static void logAssetStats( void ) {
+
+	prismaticLogger->infof( "%u cached assets, %u bytes", (unsigned int)assetCount, (unsigned int)totalBytes );
+
+	for( size_t i = 0; i < assetCount; i++ ) {
+		prismaticLogger->infof( "  %s%s: %u refs, %u bytes", assets[i]->path, assets[i]->table != NULL ? " (table)" : "", (unsigned int)assets[i]->refs, (unsigned int)assets[i]->bytes );
+	}
+
+}
+
+static PrismAsset* loadAsset( string path, bool isTable, const char** outErr ) {
+
+	if( outErr != NULL ) {
+		*outErr = NULL;
+	}
+
+	if( path == NULL ) {
+		prismaticLogger->error( "Cannot load asset with NULL path" );
+		return NULL;
+	}
+
+	PrismHashMap** index = isTable ? &tableIndex : &bitmapIndex;
+
+	if( *index == NULL ) {
+		*index = prismaticHashMap->new( 0 );
+		if( *index == NULL ) {
+			return NULL;
+		}
+	}
+
+	if( handleIndex == NULL ) {
+		handleIndex = prismaticHashMap->newPointerKeyed( 0 );
+		if( handleIndex == NULL ) {
+			return NULL;
+		}
+	}
+
+	PrismAsset* asset = prismaticHashMap->get( *index, path );
+	if( asset != NULL ) {
+		asset->refs++;
+		return asset;
+	}
+
+	PrismAsset** grown = prismaticArray->reserve( assets, &assetCapacity, assetCount + 1, sizeof( PrismAsset* ) );
+	if( grown == NULL ) {
+		prismaticLogger->errorf( "Memory allocation failed for caching asset '%s'", path );
+		return NULL;
+	}
+
+	assets = grown;
+
+	asset = calloc( 1, sizeof( PrismAsset ) );
+	if( asset == NULL ) {
+		prismaticLogger->error( "Could not allocate memory for new asset" );
+		return NULL;
+	}
+
+	const char* err = NULL;
+
+	if( isTable ) {
+		asset->table = graphics->loadBitmapTable( path, &err );
+	} else {
+		asset->bitmap = graphics->loadBitmap( path, &err );
+	}
+
+	if( outErr != NULL ) {
+		*outErr = err;
+	}
+
+	if( ( asset->table == NULL && asset->bitmap == NULL ) || err != NULL ) {
+
+		if( asset->table != NULL ) {
+			graphics->freeBitmapTable( asset->table );
+		}
+
+		if( asset->bitmap != NULL ) {
+			graphics->freeBitmap( asset->bitmap );
+		}
+
+		free( asset );
+		return NULL;
+
+	}
+
+	asset->path = prismaticString->new( path );
+	asset->refs = 1;
+	asset->bytes = isTable ? tableBytes( asset->table ) : bitmapBytes( asset->bitmap );
+	asset->_slot = assetCount;
+
+	assets[assetCount++] = asset;
+	totalBytes += asset->bytes;
+
+	if( 
+		asset->path == NULL 
+		|| !prismaticHashMap->set( *index, asset->path, asset ) 
+		|| !prismaticHashMap->set( handleIndex, assetHandle( asset ), asset ) 
+	) {
+		prismaticLogger->errorf( "Could not index asset '%s'", path );
+		freeAsset( asset );
+		return NULL;
+	}
+
+	return asset;
+
+}
+
+static bool releaseAsset( const void* handle, bool isTable ) {
+
+	PrismAsset* asset = findAsset( handle, isTable );
+	if( asset == NULL ) {
+		return false;
+	}
+
+	asset->refs--;
+	if( asset->refs > 0 ) {
+		return true;
+	}
+
+	freeAsset( asset );
+
+	return true;
+
+}
+
+// Drop an asset from the cache and its indexes and free it
+static void freeAsset( PrismAsset* asset ) {
+
+	// Removing a key that failed to index does nothing
+	if( asset->path != NULL ) {
+		prismaticHashMap->remove( asset->table != NULL ? tableIndex : bitmapIndex, asset->path );
+	}
+
+	prismaticHashMap->remove( handleIndex, assetHandle( asset ) );
+
+	// Order does not matter, move the last asset into the hole
+	assets[asset->_slot] = assets[--assetCount];
+	assets[asset->_slot]->_slot = asset->_slot;
+	assets[assetCount] = NULL;
+	totalBytes -= asset->bytes;
+
+	if( asset->table != NULL ) {
+		graphics->freeBitmapTable( asset->table );
+	} else {
+		graphics->freeBitmap( asset->bitmap );
+	}
+
+	prismaticString->delete( asset->path );
+	free( asset );
+
+	if( assetCount == 0 ) {
+		assets = prismaticArray->release( assets, &assetCapacity );
+		prismaticHashMap->delete( bitmapIndex );
+		prismaticHashMap->delete( tableIndex );
+		prismaticHashMap->delete( handleIndex );
+		bitmapIndex = NULL;
+		tableIndex = NULL;
+		handleIndex = NULL;
+	}
+
+}
+
+// Find the cached asset for a handle, only if it is the kind of handle the
+// caller expects, so a table is never released as a bitmap or the reverse
+static PrismAsset* findAsset( const void* handle, bool isTable ) {
+
+	if( handle == NULL || handleIndex == NULL ) {
+		return NULL;
+	}
+
+	PrismAsset* asset = prismaticHashMap->get( handleIndex, (const char*)handle );
+	if( asset == NULL || ( asset->table != NULL ) != isTable ) {
+		return NULL;
+	}
+
+	return asset;
+
+}
+
+// The asset's key in the handle index
+static const char* assetHandle( PrismAsset* asset ) {
+	return asset->table != NULL ? (const char*)asset->table : (const char*)asset->bitmap;
+}
+
+static size_t bitmapBytes( LCDBitmap* bitmap ) {
+
+	int height = 0, rowBytes = 0;
+	uint8_t* mask = NULL;
+
+	graphics->getBitmapData( bitmap, NULL, &height, &rowBytes, &mask, NULL );
+
+	size_t bytes = (size_t)rowBytes * (size_t)height;
+
+	return mask != NULL ? bytes * 2 : bytes;
+
+}
+
+// Every cell of a table is the same size, so measure the first one
+static size_t tableBytes( LCDBitmapTable* table ) {
+
+	int count = 0;
+	graphics->getBitmapTableInfo( table, &count, NULL );
+
+	if( count <= 0 ) {
+		return 0;
+	}
+
+	return bitmapBytes( graphics->getTableBitmap( table, 0 ) ) * (size_t)count;
+
+}
+
+const AssetsFn* prismaticAssets = &(AssetsFn) {
+	.loadBitmap = loadBitmap,
+	.retain = retainBitmap,
+	.release = releaseBitmap,
+	.loadBitmapTable = loadBitmapTable,
+	.releaseTable = releaseTable,
+	.count = countAssets,
+	.residentBytes = residentBytes,
+	.logStats = logAssetStats,
+};
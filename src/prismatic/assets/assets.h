@@ -0,0 +1,116 @@
+#ifndef ASSETS_H
+#define ASSETS_H
+
+#ifndef STDBOOL_INCLUDED
+	#define STDBOOL_INCLUDED
+	#include <stdbool.h>
+#endif
+
+#ifndef STDDEF_INCLUDED
+	#define STDDEF_INCLUDED
+	#include <stddef.h>
+#endif
+
+#ifndef PD_API_INCLUDED
+	#define PD_API_INCLUDED
+	#include "pd_api.h"
+#endif
+
+#ifndef TEXT_INCLUDED
+	#define TEXT_INCLUDED
+	#include "../text/text.h"
+#endif
+
+// A bitmap or bitmap table shared by everything that loaded it from the 
+// same path. Only one of bitmap and table is set.
+typedef struct PrismAsset {
+	// Owned copy of the path the asset was loaded from
+	string path;
+	LCDBitmap* bitmap;
+	LCDBitmapTable* table;
+	// Number of holders, the asset is freed when this reaches 0
+	size_t refs;
+	// Size of the pixel and mask data
+	size_t bytes;
+	// Position in the asset cache
+	size_t _slot;
+} PrismAsset;
+
+typedef struct AssetsFn {
+	// Load a bitmap through the cache
+	//
+	// The first load of a path decodes the file, later loads return the same
+	// LCDBitmap* and add a reference to it. Each load must be paired with a
+	// prismaticAssets->release. The bitmap must not be freed directly.
+	//
+	// Returns NULL if the bitmap could not be loaded.
+	//
+	// ----
+	//
+	// string path - Path to the image on the file system. Do not include
+	// extension.
+	//
+	// const char** outErr - Optional - Set to the error if loading failed
+	LCDBitmap* ( *loadBitmap )( string, const char** );
+
+	// Add a reference to a cached bitmap
+	//
+	// Returns false, without doing anything, if the bitmap was not loaded
+	// through the cache.
+	//
+	// ----
+	//
+	// LCDBitmap* bitmap
+	bool ( *retain )( LCDBitmap* );
+
+	// Drop a reference to a cached bitmap, freeing it once no references
+	// are left
+	//
+	// Returns false, without doing anything, if the bitmap was not loaded
+	// through the cache, or is a bitmap table. The caller still owns such 
+	// bitmaps.
+	//
+	// ----
+	//
+	// LCDBitmap* bitmap
+	bool ( *release )( LCDBitmap* );
+
+	// Load a bitmap table through the cache
+	//
+	// Works like loadBitmap. Each load must be paired with a 
+	// prismaticAssets->releaseTable.
+	//
+	// ----
+	//
+	// string path - Path to the table on the file system, without the 
+	// -table-W-H suffix or extension. e.g. "assets/images/player" for
+	// player-table-32-32.png
+	//
+	// const char** outErr - Optional - Set to the error if loading failed
+	LCDBitmapTable* ( *loadBitmapTable )( string, const char** );
+
+	// Drop a reference to a cached bitmap table, freeing it once no 
+	// references are left
+	//
+	// Returns false, without doing anything, if the table was not loaded
+	// through the cache, or is a bitmap. The caller still owns such tables.
+	//
+	// ----
+	//
+	// LCDBitmapTable* table
+	bool ( *releaseTable )( LCDBitmapTable* );
+
+	// Get the number of bitmaps and bitmap tables in the cache
+	size_t ( *count )( void );
+
+	// Get the total size of the pixel and mask data of everything in the
+	// cache, in bytes
+	size_t ( *residentBytes )( void );
+
+	// Log each cached asset's path, references and size
+	void ( *logStats )( void );
+} AssetsFn;
+
+extern const AssetsFn* prismaticAssets;
+
+#endif // ASSETS_H
@@ -0,0 +1,52 @@
+#include <stddef.h>
+#include <stdlib.h>
+
+#include "../prismatic.h"
+#include "array.h"
+
+#define ARRAY_MIN_CAPACITY 4
+
+static void* reserveArray( void* array, size_t* capacity, size_t count, size_t elementSize );
+static void* releaseArray( void* array, size_t* capacity );
+
+static void* reserveArray( void* array, size_t* capacity, size_t count, size_t elementSize ) {
+
+	if( array != NULL && count <= *capacity ) {
+		return array;
+	}
+
+	size_t newCapacity = *capacity > 0 ? *capacity : ARRAY_MIN_CAPACITY;
+	while( newCapacity < count ) {
+		newCapacity *= 2;
+	}
+
+	void* grown = sys->realloc( array, newCapacity * elementSize );
+	if( grown == NULL ) {
+		prismaticLogger->errorf( "Could not grow array to %d elements", (int)newCapacity );
+		return NULL;
+	}
+
+	*capacity = newCapacity;
+
+	return grown;
+
+}
+
+static void* releaseArray( void* array, size_t* capacity ) {
+
+	if( array != NULL ) {
+		sys->realloc( array, 0 );
+	}
+
+	if( capacity != NULL ) {
+		*capacity = 0;
+	}
+
+	return NULL;
+
+}
+
+const ArrayFn* prismaticArray = &(ArrayFn) {
+	.reserve = reserveArray,
+	.release = releaseArray,
+};
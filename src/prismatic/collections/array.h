@@ -0,0 +1,44 @@
+#ifndef ARRAY_H
+#define ARRAY_H
+
+#ifndef STDDEF_INCLUDED
+	#define STDDEF_INCLUDED
+	#include <stddef.h>
+#endif
+
+typedef struct ArrayFn {
+	// Grow an array so that it can hold at least count elements
+	//
+	// Capacity grows geometrically, so appending one element at a time costs 
+	// a logarithmic number of reallocations. For NULL terminated arrays, 
+	// include the terminator in count.
+	//
+	// Returns the (possibly moved) array, or NULL if memory could not be 
+	// allocated. On failure the original array and capacity are left 
+	// untouched, so the caller still owns the old array.
+	//
+	// ----
+	//
+	// void* array - The array to grow, may be NULL
+	//
+	// size_t* capacity - The array's capacity, in elements. Updated on growth
+	//
+	// size_t count - The number of elements the array needs to hold
+	//
+	// size_t elementSize - The size of a single element, e.g. sizeof( T* )
+	void* ( *reserve )( void*, size_t*, size_t, size_t );
+
+	// Free an array grown with prismaticArray->reserve and reset its 
+	// capacity. Always returns NULL, so it can be assigned back to the array.
+	//
+	// ----
+	//
+	// void* array
+	//
+	// size_t* capacity
+	void* ( *release )( void*, size_t* );
+} ArrayFn;
+
+extern const ArrayFn* prismaticArray;
+
+#endif // ARRAY_H
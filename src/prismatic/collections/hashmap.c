@@ -0,0 +1,268 @@
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "../prismatic.h"
+#include "hashmap.h"
+
+#define HASHMAP_MIN_CAPACITY 8
+
+static PrismHashMap* newHashMap( size_t capacity );
+static PrismHashMap* newPointerKeyed( size_t capacity );
+static void deleteHashMap( PrismHashMap* map );
+static bool setHashMap( PrismHashMap* map, const char* key, void* value );
+static void* getHashMap( PrismHashMap* map, const char* key );
+static void* removeHashMap( PrismHashMap* map, const char* key );
+static void clearHashMap( PrismHashMap* map );
+static uint32_t hashString( const char* key );
+static uint32_t hashKey( PrismHashMap* map, const char* key );
+
+static bool resizeHashMap( PrismHashMap* map, size_t capacity );
+static PrismHashMapEntry* findEntry( PrismHashMapEntry* entries, size_t capacity, const char* key, uint32_t hash, bool pointerKeys );
+
+// Marks a slot that held a removed key, so probing continues past it
+static const char tombstone = '\0';
+#define TOMBSTONE (&tombstone)
+
+static PrismHashMap* newHashMap( size_t capacity ) {
+
+	PrismHashMap* map = calloc( 1, sizeof( PrismHashMap ) );
+	if( map == NULL ) {
+		prismaticLogger->error( "Could not allocate memory for new hash map" );
+		return NULL;
+	}
+
+	// Reserve enough slots to hold capacity keys below the load factor
+	size_t slots = HASHMAP_MIN_CAPACITY;
+	while( slots * 3 < capacity * 4 ) {
+		slots <<= 1;
+	}
+
+	if( !resizeHashMap( map, slots ) ) {
+		free( map );
+		return NULL;
+	}
+
+	return map;
+
+}
+
+static PrismHashMap* newPointerKeyed( size_t capacity ) {
+
+	PrismHashMap* map = newHashMap( capacity );
+	if( map != NULL ) {
+		map->_pointerKeys = true;
+	}
+
+	return map;
+
+}
+
+static void deleteHashMap( PrismHashMap* map ) {
+
+	if( map == NULL ) {
+		return;
+	}
+
+	map->entries = sys->realloc( map->entries, 0 );
+	map->entries = NULL;
+	map->capacity = 0;
+	map->count = 0;
+
+	free( map );
+	map = NULL;
+
+}
+
+static bool setHashMap( PrismHashMap* map, const char* key, void* value ) {
+
+	if( map == NULL || key == NULL || value == NULL ) {
+		prismaticLogger->error( "Cannot set NULL key or value in hash map" );
+		return false;
+	}
+
+	// Keep the map at most 3/4 full, counting tombstones as used
+	if( ( map->count + map->_tombstones + 1 ) * 4 > map->capacity * 3 ) {
+
+		size_t capacity = map->capacity;
+		if( ( map->count + 1 ) * 2 > capacity ) {
+			capacity <<= 1;
+		}
+
+		if( !resizeHashMap( map, capacity ) ) {
+			return false;
+		}
+
+	}
+
+	uint32_t hash = hashKey( map, key );
+	PrismHashMapEntry* entry = findEntry( map->entries, map->capacity, key, hash, map->_pointerKeys );
+
+	if( entry->key == NULL ) {
+		map->count++;
+	} else if( entry->key == TOMBSTONE ) {
+		map->count++;
+		map->_tombstones--;
+	}
+
+	entry->key = key;
+	entry->hash = hash;
+	entry->value = value;
+
+	return true;
+
+}
+
+static void* getHashMap( PrismHashMap* map, const char* key ) {
+
+	if( map == NULL || key == NULL || map->count == 0 ) {
+		return NULL;
+	}
+
+	PrismHashMapEntry* entry = findEntry( map->entries, map->capacity, key, hashKey( map, key ), map->_pointerKeys );
+	if( entry->key == NULL || entry->key == TOMBSTONE ) {
+		return NULL;
+	}
+
+	return entry->value;
+
+}
+
+static void* removeHashMap( PrismHashMap* map, const char* key ) {
+
+	if( map == NULL || key == NULL || map->count == 0 ) {
+		return NULL;
+	}
+
+	PrismHashMapEntry* entry = findEntry( map->entries, map->capacity, key, hashKey( map, key ), map->_pointerKeys );
+	if( entry->key == NULL || entry->key == TOMBSTONE ) {
+		return NULL;
+	}
+
+	void* value = entry->value;
+
+	entry->key = TOMBSTONE;
+	entry->value = NULL;
+	map->count--;
+	map->_tombstones++;
+
+	return value;
+
+}
+
+static void clearHashMap( PrismHashMap* map ) {
+
+	if( map == NULL || map->entries == NULL ) {
+		return;
+	}
+
+	memset( map->entries, 0, sizeof( PrismHashMapEntry ) * map->capacity );
+	map->count = 0;
+	map->_tombstones = 0;
+
+}
+
+static uint32_t hashString( const char* key ) {
+
+	uint32_t hash = 2166136261u;
+
+	for( const unsigned char* c = (const unsigned char*)key; *c != '\0'; c++ ) {
+		hash ^= *c;
+		hash *= 16777619u;
+	}
+
+	return hash;
+
+}
+
+// Hash a key as the map compares it. Pointers are mixed so that aligned
+// addresses, whose low bits are all zero, spread over the table.
+static uint32_t hashKey( PrismHashMap* map, const char* key ) {
+
+	if( !map->_pointerKeys ) {
+		return hashString( key );
+	}
+
+	uint64_t value = (uint64_t)(uintptr_t)key;
+	value ^= value >> 33;
+	value *= 0xff51afd7ed558ccdull;
+	value ^= value >> 33;
+
+	return (uint32_t)value;
+
+}
+
+// Rehash every live entry into a new table with the given capacity. capacity
+// must be a power of two. Tombstones are dropped along the way.
+static bool resizeHashMap( PrismHashMap* map, size_t capacity ) {
+
+	PrismHashMapEntry* entries = sys->realloc( NULL, sizeof( PrismHashMapEntry ) * capacity );
+	if( entries == NULL ) {
+		prismaticLogger->error( "Could not allocate memory for hash map entries" );
+		return false;
+	}
+
+	memset( entries, 0, sizeof( PrismHashMapEntry ) * capacity );
+
+	for( size_t i = 0; i < map->capacity; i++ ) {
+
+		PrismHashMapEntry* old = &map->entries[i];
+		if( old->key == NULL || old->key == TOMBSTONE ) {
+			continue;
+		}
+
+		PrismHashMapEntry* entry = findEntry( entries, capacity, old->key, old->hash, map->_pointerKeys );
+		*entry = *old;
+
+	}
+
+	sys->realloc( map->entries, 0 );
+
+	map->entries = entries;
+	map->capacity = capacity;
+	map->_tombstones = 0;
+
+	return true;
+
+}
+
+// Find the slot holding key, or the slot key should be inserted into. The
+// first tombstone on the probe path is reused for inserts.
+static PrismHashMapEntry* findEntry( PrismHashMapEntry* entries, size_t capacity, const char* key, uint32_t hash, bool pointerKeys ) {
+
+	size_t mask = capacity - 1;
+	size_t i = hash & mask;
+	PrismHashMapEntry* firstTombstone = NULL;
+
+	for( ;; ) {
+
+		PrismHashMapEntry* entry = &entries[i];
+
+		if( entry->key == NULL ) {
+			return firstTombstone != NULL ? firstTombstone : entry;
+		}
+
+		if( entry->key == TOMBSTONE ) {
+			if( firstTombstone == NULL ) {
+				firstTombstone = entry;
+			}
+		} else if( entry->hash == hash && ( entry->key == key || ( !pointerKeys && strcmp( entry->key, key ) == 0 ) ) ) {
+			return entry;
+		}
+
+		i = ( i + 1 ) & mask;
+
+	}
+
+}
+
+const HashMapFn* prismaticHashMap = &(HashMapFn) {
+	.new = newHashMap,
+	.newPointerKeyed = newPointerKeyed,
+	.delete = deleteHashMap,
+	.set = setHashMap,
+	.get = getHashMap,
+	.remove = removeHashMap,
+	.clear = clearHashMap,
+	.hash = hashString,
+};
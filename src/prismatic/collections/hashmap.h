@@ -0,0 +1,118 @@
+#ifndef HASHMAP_H
+#define HASHMAP_H
+
+#ifndef STDBOOL_INCLUDED
+	#define STDBOOL_INCLUDED
+	#include <stdbool.h>
+#endif
+
+#ifndef STDDEF_INCLUDED
+	#define STDDEF_INCLUDED
+	#include <stddef.h>
+#endif
+
+#ifndef STDINT_INCLUDED
+	#define STDINT_INCLUDED
+	#include <stdint.h>
+#endif
+
+typedef struct PrismHashMapEntry {
+	const char* key;
+	uint32_t hash;
+	void* value;
+} PrismHashMapEntry;
+
+// An open-addressing (linear probing) map from string keys to pointers.
+//
+// Keys are not copied, the caller must keep each key alive for as long as it
+// is stored in the map. Usually the key is a name or id owned by the value.
+// Maps created with newPointerKeyed compare keys by address instead.
+typedef struct PrismHashMap {
+	PrismHashMapEntry* entries;
+	size_t capacity;
+	size_t count;
+	size_t _tombstones;
+	// Set for maps created with newPointerKeyed
+	bool _pointerKeys;
+} PrismHashMap;
+
+typedef struct HashMapFn {
+	// Create a new PrismHashMap
+	//
+	// ----
+	//
+	// size_t capacity - The number of entries to reserve space for. Pass 0
+	// for the default.
+	PrismHashMap* ( *new )( size_t );
+
+	// Create a new PrismHashMap keyed by address
+	//
+	// Keys are hashed and compared as pointers and never read, so any 
+	// pointer cast to const char* can be a key. Use it to find what owns a 
+	// handle, such as a bitmap, without formatting the handle as a string.
+	//
+	// ----
+	//
+	// size_t capacity - The number of entries to reserve space for. Pass 0
+	// for the default.
+	PrismHashMap* ( *newPointerKeyed )( size_t );
+
+	// Delete a PrismHashMap
+	//
+	// Frees only the map, keys and values are owned by the caller.
+	//
+	// ----
+	//
+	// PrismHashMap* map
+	void ( *delete )( PrismHashMap* );
+
+	// Insert or replace the value stored for key
+	//
+	// Returns false if the map could not grow to fit the new key.
+	//
+	// ----
+	//
+	// PrismHashMap* map
+	//
+	// const char* key
+	//
+	// void* value - Must not be NULL, NULL is used to signal a missing key
+	bool ( *set )( PrismHashMap*, const char*, void* );
+
+	// Get the value stored for key, or NULL if the key is not in the map
+	//
+	// ----
+	//
+	// PrismHashMap* map
+	//
+	// const char* key
+	void* ( *get )( PrismHashMap*, const char* );
+
+	// Remove key from the map and return its value, or NULL if the key is not
+	// in the map
+	//
+	// ----
+	//
+	// PrismHashMap* map
+	//
+	// const char* key
+	void* ( *remove )( PrismHashMap*, const char* );
+
+	// Remove all keys from the map, keeping its capacity
+	//
+	// ----
+	//
+	// PrismHashMap* map
+	void ( *clear )( PrismHashMap* );
+
+	// Hash a string with the same function the map uses (32-bit FNV-1a)
+	//
+	// ----
+	//
+	// const char* key
+	uint32_t ( *hash )( const char* );
+} HashMapFn;
+
+extern const HashMapFn* prismaticHashMap;
+
+#endif // HASHMAP_H
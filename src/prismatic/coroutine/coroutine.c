@@ -0,0 +1,63 @@
+#include <stddef.h>
+
+#include "../prismatic.h"
+#include "coroutine.h"
+
+static void startCoroutine( PrismCoroutine* co, bool ( *run )( PrismCoroutine*, float ), void* data );
+static bool resumeCoroutine( PrismCoroutine* co, float delta );
+static bool isCoroutineRunning( PrismCoroutine* co );
+
+static void startCoroutine( PrismCoroutine* co, bool ( *run )( PrismCoroutine*, float ), void* data ) {
+
+	if( co == NULL ) {
+		prismaticLogger->error( "Cannot start a NULL coroutine" );
+		return;
+	}
+
+	co->run = run;
+	co->data = data;
+	co->_resume = 0;
+	co->_wait = 0.0f;
+	co->_waitFor = NULL;
+	co->_done = run == NULL;
+
+}
+
+static bool resumeCoroutine( PrismCoroutine* co, float delta ) {
+
+	if( co == NULL || co->_done ) {
+		return true;
+	}
+
+	if( co->_wait > 0.0f ) {
+		co->_wait -= delta;
+		if( co->_wait > 0.0f ) {
+			return false;
+		}
+		co->_wait = 0.0f;
+	}
+
+	if( co->_waitFor != NULL ) {
+		if( !co->_waitFor->finished ) {
+			return false;
+		}
+		co->_waitFor = NULL;
+	}
+
+	if( co->run( co, delta ) ) {
+		co->_done = true;
+	}
+
+	return co->_done;
+
+}
+
+static bool isCoroutineRunning( PrismCoroutine* co ) {
+	return co != NULL && co->run != NULL && !co->_done;
+}
+
+const CoroutineFn* prismaticCoroutine = &(CoroutineFn) {
+	.start = startCoroutine,
+	.resume = resumeCoroutine,
+	.isRunning = isCoroutineRunning,
+};
@@ -0,0 +1,117 @@
+#ifndef COROUTINE_H
+#define COROUTINE_H
+
+#ifndef STDBOOL_INCLUDED
+	#define STDBOOL_INCLUDED
+	#include <stdbool.h>
+#endif
+
+#ifndef TRANSITION_INCLUDED
+	#define TRANSITION_INCLUDED
+	#include "../transition/transition.h"
+#endif
+
+// A stackless coroutine. All of its state lives in this struct, so it can be
+// embedded in a Scene's or Sprite's data and never needs to be allocated.
+//
+// The body is a run function wrapped in PRISM_CO_BEGIN / PRISM_CO_END. Local
+// variables are not kept across a yield or wait, keep anything that must
+// survive in data instead. A yield or wait cannot be placed inside a switch
+// statement of the run function, and there can be at most one per line.
+typedef struct PrismCoroutine {
+	// Optional - Data for the coroutine. Caller is responsible for freeing it.
+	void* data;
+	// Where to resume the run function, 0 to start from the top
+	int _resume;
+	// Seconds left to wait before resuming
+	float _wait;
+	// Transition to wait for before resuming
+	PrismTransition* _waitFor;
+	bool _done;
+	// The Scene running the coroutine, see prismaticScene->startCoroutine
+	struct Scene* _scene;
+	struct PrismCoroutine* _next;
+	// Runs the coroutine until its next yield or wait. Returns true once the
+	// coroutine has finished, PRISM_CO_END does this.
+	//
+	// ----
+	//
+	// PrismCoroutine* self
+	//
+	// float delta - The time, in seconds, since the last update
+	bool ( *run )( struct PrismCoroutine*, float );
+} PrismCoroutine;
+
+// Start the body of a run function
+#define PRISM_CO_BEGIN( co ) switch( ( co )->_resume ) { case 0:
+
+// End the body of a run function, finishing the coroutine
+#define PRISM_CO_END( co ) } ( co )->_resume = 0; return true
+
+// Suspend until the next update
+#define PRISM_CO_YIELD( co ) \
+	do { \
+		( co )->_resume = __LINE__; \
+		return false; \
+		case __LINE__:; \
+	} while( 0 )
+
+// Suspend for the given number of seconds
+#define PRISM_CO_WAIT( co, seconds ) \
+	do { \
+		( co )->_wait = ( seconds ); \
+		PRISM_CO_YIELD( co ); \
+	} while( 0 )
+
+// Suspend until a PrismTransition has finished. The transition still needs to
+// be played, usually from the Scene's draw function.
+#define PRISM_CO_WAIT_FOR( co, transition ) \
+	do { \
+		( co )->_waitFor = ( transition ); \
+		PRISM_CO_YIELD( co ); \
+	} while( 0 )
+
+// Suspend until condition is true, checking once per update
+#define PRISM_CO_WAIT_UNTIL( co, condition ) \
+	while( !( condition ) ) { \
+		PRISM_CO_YIELD( co ); \
+	}
+
+typedef struct CoroutineFn {
+	// Set up a coroutine to run from the top of run
+	//
+	// Only needed to drive a coroutine by hand with resume. Coroutines
+	// started with prismaticScene->startCoroutine are resumed by the
+	// SceneManager.
+	//
+	// ----
+	//
+	// PrismCoroutine* co
+	//
+	// bool ( *run )( PrismCoroutine*, float )
+	//
+	// void* data
+	void ( *start )( PrismCoroutine*, bool (*)( PrismCoroutine*, float ), void* );
+
+	// Resume a coroutine, unless it is still waiting
+	//
+	// Returns true once the coroutine has finished.
+	//
+	// ----
+	//
+	// PrismCoroutine* co
+	//
+	// float delta - The time, in seconds, since the last update
+	bool ( *resume )( PrismCoroutine*, float );
+
+	// Check whether a coroutine has been started and has not finished
+	//
+	// ----
+	//
+	// PrismCoroutine* co
+	bool ( *isRunning )( PrismCoroutine* );
+} CoroutineFn;
+
+extern const CoroutineFn* prismaticCoroutine;
+
+#endif // COROUTINE_H
@@ -0,0 +1,306 @@
+#include <stddef.h>
+#include <stdlib.h>
+
+#include "../prismatic.h"
+#include "particles.h"
+
+static PrismEmitter* newEmitter( size_t capacity, int width, int height );
+static void deleteEmitter( PrismEmitter* emitter );
+static void emitParticles( PrismEmitter* emitter, size_t count );
+static void updateEmitter( PrismEmitter* emitter, float delta );
+static void drawEmitter( PrismEmitter* emitter );
+static void moveEmitter( PrismEmitter* emitter, float x, float y );
+static void clearEmitter( PrismEmitter* emitter );
+
+static void drawParticles( PrismEmitter* emitter, int offsetX, int offsetY );
+static float randomBetween( PrismEmitter* emitter, float min, float max );
+
+static PrismEmitter* newEmitter( size_t capacity, int width, int height ) {
+
+	if( capacity < 1 ) {
+		prismaticLogger->error( "Cannot create emitter with no capacity" );
+		return NULL;
+	}
+
+	PrismEmitter* emitter = calloc( 1, sizeof( PrismEmitter ) );
+	if( emitter == NULL ) {
+		prismaticLogger->error( "Could not allocate memory for new emitter" );
+		return NULL;
+	}
+
+	// Every array lives in one block, frames last since they are the
+	// smallest and floats need the alignment
+	uint8_t* block = malloc( capacity * ( sizeof( float ) * 5 + sizeof( uint8_t ) ) );
+	if( block == NULL ) {
+		prismaticLogger->error( "Could not allocate memory for particles" );
+		free( emitter );
+		return NULL;
+	}
+
+	emitter->x = (float*)block;
+	emitter->y = emitter->x + capacity;
+	emitter->vx = emitter->y + capacity;
+	emitter->vy = emitter->vx + capacity;
+	emitter->life = emitter->vy + capacity;
+	emitter->frame = (uint8_t*)( emitter->life + capacity );
+	emitter->capacity = capacity;
+
+	emitter->lifetime = 1.0f;
+	emitter->minVX = -20.0f;
+	emitter->maxVX = 20.0f;
+	emitter->minVY = -20.0f;
+	emitter->maxVY = 20.0f;
+	emitter->size = 2;
+	emitter->color = kColorBlack;
+	emitter->_seed = ( 0x9E3779B9u ^ (uint32_t)(uintptr_t)emitter ) | 1;
+
+	if( width > 0 && height > 0 ) {
+
+		emitter->canvas = graphics->newBitmap( width, height, kColorClear );
+		emitter->sprite = emitter->canvas != NULL ? sprites->newSprite() : NULL;
+
+		if( emitter->sprite == NULL ) {
+			prismaticLogger->error( "Could not create emitter canvas" );
+			deleteEmitter( emitter );
+			return NULL;
+		}
+
+		sprites->setImage( emitter->sprite, emitter->canvas, kBitmapUnflipped );
+
+	}
+
+	return emitter;
+
+}
+
+static void deleteEmitter( PrismEmitter* emitter ) {
+
+	if( emitter == NULL ) {
+		return;
+	}
+
+	if( emitter->sprite != NULL ) {
+		sprites->setImage( emitter->sprite, NULL, kBitmapUnflipped );
+		sprites->removeSprite( emitter->sprite );
+		sprites->freeSprite( emitter->sprite );
+	}
+
+	if( emitter->canvas != NULL ) {
+		graphics->freeBitmap( emitter->canvas );
+	}
+
+	// x is the start of the block holding every array
+	free( emitter->x );
+	free( emitter );
+
+}
+
+static void emitParticles( PrismEmitter* emitter, size_t count ) {
+
+	if( emitter == NULL ) {
+		prismaticLogger->error( "Cannot emit from NULL emitter" );
+		return;
+	}
+
+	if( count > emitter->capacity - emitter->count ) {
+		count = emitter->capacity - emitter->count;
+	}
+
+	for( size_t i = emitter->count; i < emitter->count + count; i++ ) {
+		emitter->x[i] = emitter->originX;
+		emitter->y[i] = emitter->originY;
+		emitter->vx[i] = randomBetween( emitter, emitter->minVX, emitter->maxVX );
+		emitter->vy[i] = randomBetween( emitter, emitter->minVY, emitter->maxVY );
+		emitter->life[i] = emitter->lifetime;
+		emitter->frame[i] = 0;
+	}
+
+	emitter->count += count;
+
+}
+
+static void updateEmitter( PrismEmitter* emitter, float delta ) {
+
+	if( emitter == NULL ) {
+		prismaticLogger->error( "Cannot update NULL emitter" );
+		return;
+	}
+
+	if( emitter->rate > 0 ) {
+
+		emitter->_spawnTimer += delta * emitter->rate;
+
+		size_t spawns = (size_t)emitter->_spawnTimer;
+		emitter->_spawnTimer -= (float)spawns;
+
+		emitParticles( emitter, spawns );
+
+	}
+
+	if( emitter->frames != NULL ) {
+		graphics->getBitmapTableInfo( emitter->frames, &emitter->_frameCount, NULL );
+	} else {
+		emitter->_frameCount = 0;
+	}
+
+	float* x = emitter->x;
+	float* y = emitter->y;
+	float* vx = emitter->vx;
+	float* vy = emitter->vy;
+	float* life = emitter->life;
+	uint8_t* frame = emitter->frame;
+
+	float ax = emitter->gravityX * delta;
+	float ay = emitter->gravityY * delta;
+	float lifetime = emitter->lifetime;
+	float frameRate = lifetime > 0 ? (float)emitter->_frameCount / lifetime : 0;
+	int lastFrame = emitter->_frameCount > 0 ? emitter->_frameCount - 1 : 0;
+	size_t count = emitter->count;
+
+	for( size_t i = 0; i < count; i++ ) {
+
+		vx[i] += ax;
+		vy[i] += ay;
+		x[i] += vx[i] * delta;
+		y[i] += vy[i] * delta;
+		life[i] -= delta;
+
+		int f = (int)( ( lifetime - life[i] ) * frameRate );
+		frame[i] = (uint8_t)( f < lastFrame ? f : lastFrame );
+
+	}
+
+	// Move the last live particle into each dead one, order does not matter
+	for( size_t i = count; i-- > 0; ) {
+
+		if( life[i] > 0 ) {
+			continue;
+		}
+
+		count--;
+		x[i] = x[count];
+		y[i] = y[count];
+		vx[i] = vx[count];
+		vy[i] = vy[count];
+		life[i] = life[count];
+		frame[i] = frame[count];
+
+	}
+
+	emitter->count = count;
+
+}
+
+static void drawEmitter( PrismEmitter* emitter ) {
+
+	if( emitter == NULL ) {
+		prismaticLogger->error( "Cannot draw NULL emitter" );
+		return;
+	}
+
+	if( emitter->canvas == NULL ) {
+		drawParticles( emitter, 0, 0 );
+		return;
+	}
+
+	int width = 0, height = 0;
+	graphics->getBitmapData( emitter->canvas, &width, &height, NULL, NULL, NULL );
+
+	graphics->pushContext( emitter->canvas );
+	graphics->clear( kColorClear );
+	drawParticles( emitter, width / 2 - (int)emitter->originX, height / 2 - (int)emitter->originY );
+	graphics->popContext();
+
+	sprites->markDirty( emitter->sprite );
+
+}
+
+static void moveEmitter( PrismEmitter* emitter, float x, float y ) {
+
+	if( emitter == NULL ) {
+		prismaticLogger->error( "Cannot move NULL emitter" );
+		return;
+	}
+
+	emitter->originX = x;
+	emitter->originY = y;
+
+	if( emitter->sprite != NULL ) {
+		sprites->moveTo( emitter->sprite, x, y );
+	}
+
+}
+
+static void clearEmitter( PrismEmitter* emitter ) {
+
+	if( emitter == NULL ) {
+		return;
+	}
+
+	emitter->count = 0;
+	emitter->_spawnTimer = 0;
+
+}
+
+// Draw each particle centered on its position, shifted by an offset
+static void drawParticles( PrismEmitter* emitter, int offsetX, int offsetY ) {
+
+	if( emitter->frames == NULL ) {
+
+		int half = emitter->size / 2;
+
+		for( size_t i = 0; i < emitter->count; i++ ) {
+			graphics->fillRect( (int)emitter->x[i] + offsetX - half, (int)emitter->y[i] + offsetY - half, emitter->size, emitter->size, emitter->color );
+		}
+
+		return;
+
+	}
+
+	LCDBitmap* first = graphics->getTableBitmap( emitter->frames, 0 );
+	if( first == NULL ) {
+		return;
+	}
+
+	// Every cell of a table is the same size
+	int width = 0, height = 0;
+	graphics->getBitmapData( first, &width, &height, NULL, NULL, NULL );
+
+	offsetX -= width / 2;
+	offsetY -= height / 2;
+
+	for( size_t i = 0; i < emitter->count; i++ ) {
+
+		LCDBitmap* image = graphics->getTableBitmap( emitter->frames, emitter->frame[i] );
+		if( image == NULL ) {
+			continue;
+		}
+
+		graphics->drawBitmap( image, (int)emitter->x[i] + offsetX, (int)emitter->y[i] + offsetY, kBitmapUnflipped );
+
+	}
+
+}
+
+// xorshift32, seeded per emitter so emitters do not disturb rand()
+static float randomBetween( PrismEmitter* emitter, float min, float max ) {
+
+	uint32_t s = emitter->_seed;
+	s ^= s << 13;
+	s ^= s >> 17;
+	s ^= s << 5;
+	emitter->_seed = s;
+
+	return min + ( max - min ) * (float)( s >> 8 ) / 16777216.0f;
+
+}
+
+const ParticlesFn* prismaticParticles = &(ParticlesFn) {
+	.new = newEmitter,
+	.delete = deleteEmitter,
+	.emit = emitParticles,
+	.update = updateEmitter,
+	.draw = drawEmitter,
+	.moveTo = moveEmitter,
+	.clear = clearEmitter,
+};
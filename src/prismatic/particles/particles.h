@@ -0,0 +1,150 @@
+#ifndef PARTICLES_H
+#define PARTICLES_H
+
+#ifndef STDDEF_INCLUDED
+	#define STDDEF_INCLUDED
+	#include <stddef.h>
+#endif
+
+#ifndef STDINT_INCLUDED
+	#define STDINT_INCLUDED
+	#include <stdint.h>
+#endif
+
+#ifndef PD_API_INCLUDED
+	#define PD_API_INCLUDED
+	#include "pd_api.h"
+#endif
+
+// A fixed number of particles, stored as one array per property so a single
+// loop can move them all. Particles are not Sprites, an emitter is drawn
+// straight into the frame buffer, or into its canvas which is shown by a
+// single LCDSprite.
+typedef struct PrismEmitter {
+	// Particle state. Only the first count entries are live, read only.
+	float* x;
+	float* y;
+	float* vx;
+	float* vy;
+	// Seconds left to live
+	float* life;
+	// The frame of frames being drawn
+	uint8_t* frame;
+	size_t count;
+	size_t capacity;
+
+	// Where new particles spawn, set with prismaticParticles->moveTo
+	float originX;
+	float originY;
+	// Particles spawned per second by update. Default: 0
+	float rate;
+	// Seconds each particle lives. Default: 1
+	float lifetime;
+	// Range each new particle's velocity is picked from, in pixels per
+	// second. Default: -20 to 20 on both axes
+	float minVX;
+	float maxVX;
+	float minVY;
+	float maxVY;
+	// Acceleration of every particle, in pixels per second squared.
+	// Default: 0
+	float gravityX;
+	float gravityY;
+	// Optional - Frames played from first to last over a particle's life.
+	// Not owned by the emitter.
+	LCDBitmapTable* frames;
+	// Size of the square drawn for each particle when frames is NULL.
+	// Default: 2
+	int size;
+	// Default: kColorBlack
+	LCDColor color;
+
+	// Optional - The bitmap particles are drawn into, centered on the
+	// origin, see prismaticParticles->new
+	LCDBitmap* canvas;
+	// The LCDSprite showing canvas. Add it to the display list with
+	// sprites->addSprite.
+	LCDSprite* sprite;
+
+	int _frameCount;
+	float _spawnTimer;
+	uint32_t _seed;
+} PrismEmitter;
+
+typedef struct ParticlesFn {
+	// Create a new emitter
+	//
+	// All particle storage is allocated here, emitting never allocates. With
+	// a width and height, particles are drawn into a canvas of that size
+	// shown by emitter->sprite, so they are sorted with other Sprites.
+	// Without, they are drawn into the current drawing context, usually the
+	// frame buffer from a Scene's draw.
+	//
+	// ----
+	//
+	// size_t capacity - The most particles alive at once
+	//
+	// int width - Width of the canvas, or 0 for no canvas
+	//
+	// int height - Height of the canvas, or 0 for no canvas
+	PrismEmitter* ( *new )( size_t, int, int );
+
+	// Delete an emitter, its particles and its canvas
+	//
+	// ----
+	//
+	// PrismEmitter* emitter
+	void ( *delete )( PrismEmitter* );
+
+	// Spawn particles at the origin right away
+	//
+	// Stops at the emitter's capacity.
+	//
+	// ----
+	//
+	// PrismEmitter* emitter
+	//
+	// size_t count
+	void ( *emit )( PrismEmitter*, size_t );
+
+	// Spawn particles at the emitter's rate, then move every particle and
+	// remove those that ran out of life
+	//
+	// ----
+	//
+	// PrismEmitter* emitter
+	//
+	// float delta - The time, in seconds, since the last update
+	void ( *update )( PrismEmitter*, float );
+
+	// Draw every particle, into the canvas if the emitter has one, or into
+	// the current drawing context
+	//
+	// ----
+	//
+	// PrismEmitter* emitter
+	void ( *draw )( PrismEmitter* );
+
+	// Move where new particles spawn, and the canvas with it. Particles that
+	// are already alive do not move.
+	//
+	// ----
+	//
+	// PrismEmitter* emitter
+	//
+	// float x
+	//
+	// float y
+	void ( *moveTo )( PrismEmitter*, float, float );
+
+	// Remove every particle
+	//
+	// ----
+	//
+	// PrismEmitter* emitter
+	void ( *clear )( PrismEmitter* );
+} ParticlesFn;
+
+extern const ParticlesFn* prismaticParticles;
+
+#endif // PARTICLES_H
@@ -12,6 +12,16 @@ const struct playdate_sprite *sprites;
 const struct playdate_sys *sys;
 static Game* g;
 
+// Fixed timestep state, fixedStep is 0 while running with a variable step
+static float fixedStep = 0.0f;
+static int maxSteps = 0;
+static float accumulator = 0.0f;
+
+// Time kept back from background jobs at the end of each frame, in seconds
+#define SCHEDULER_FRAME_MARGIN 0.001f
+
+static void runJobs( void );
+
 void initEngine( PlaydateAPI* p ) {
 
 	pd = p;
@@ -27,14 +37,72 @@ void initEngine( PlaydateAPI* p ) {
 
 void updateEngine( float delta ) {
 
-	if( g != NULL ) {
+	if( g == NULL ) {
+		return;
+	}
+
+	if( fixedStep <= 0.0f ) {
 		g->update( delta );
-		g->draw( delta );
+		g->draw( delta, 1.0f );
+		runJobs();
+		return;
 	}
 
+	accumulator += delta;
+
+	int steps = 0;
+	while( accumulator >= fixedStep && steps < maxSteps ) {
+		g->update( fixedStep );
+		accumulator -= fixedStep;
+		steps++;
+	}
+
+	// Too far behind to catch up, drop the whole steps that are left over 
+	// rather than falling further behind every frame
+	if( accumulator >= fixedStep ) {
+		accumulator -= fixedStep * (float)(int)( accumulator / fixedStep );
+	}
+
+	g->draw( delta, accumulator / fixedStep );
+	runJobs();
+
+}
+
+// Give scheduled jobs whatever is left of the frame after update & draw
+static void runJobs( void ) {
+
+	float refreshRate = pd->display->getRefreshRate();
+	if( refreshRate <= 0.0f ) {
+		// Unlimited refresh rate, the device tops out at 50fps
+		refreshRate = 50.0f;
+	}
+
+	float budget = 1.0f / refreshRate - sys->getElapsedTime() - SCHEDULER_FRAME_MARGIN;
+	prismaticScheduler->tick( budget );
+
+}
+
+void setFixedTimestep( float step, int maxCatchUpSteps ) {
+
+	if( step <= 0.0f ) {
+		fixedStep = 0.0f;
+		accumulator = 0.0f;
+		return;
+	}
+
+	if( maxCatchUpSteps < 1 ) {
+		prismaticLogger->errorf( "setFixedTimestep: maxCatchUpSteps must be at least 1, got %d", maxCatchUpSteps );
+		maxCatchUpSteps = 1;
+	}
+
+	fixedStep = step;
+	maxSteps = maxCatchUpSteps;
+	accumulator = 0.0f;
+
 }
 
 void shutdownEngine() {
+	prismaticScheduler->clear();
 	g->destroy();
 	free( g );
 }
\ No newline at end of file
@@ -13,6 +13,21 @@
     #include "utils/utils.h"
 #endif
 
+#ifndef HASHMAP_INCLUDED
+	#define HASHMAP_INCLUDED
+	#include "collections/hashmap.h"
+#endif
+
+#ifndef ARRAY_INCLUDED
+	#define ARRAY_INCLUDED
+	#include "collections/array.h"
+#endif
+
+#ifndef ASSETS_INCLUDED
+	#define ASSETS_INCLUDED
+	#include "assets/assets.h"
+#endif
+
 #ifndef GAME_INCLUDED
 	#define GAME_INCLUDED
 	#include "../core/game.h"
@@ -28,6 +43,21 @@
 	#include "sprite/sprite.h"
 #endif
 
+#ifndef ASEPRITE_INCLUDED
+	#define ASEPRITE_INCLUDED
+	#include "aseprite/aseprite.h"
+#endif
+
+#ifndef COROUTINE_INCLUDED
+	#define COROUTINE_INCLUDED
+	#include "coroutine/coroutine.h"
+#endif
+
+#ifndef PARTICLES_INCLUDED
+	#define PARTICLES_INCLUDED
+	#include "particles/particles.h"
+#endif
+
 #ifndef SCENE_INCLUDED
 	#define SCENE_INCLUDED
 	#include "scene/scene.h"
@@ -48,6 +78,11 @@
 	#include "tilemap/ldtk.h"
 #endif
 
+#ifndef SCHEDULER_INCLUDED
+	#define SCHEDULER_INCLUDED
+	#include "scheduler/scheduler.h"
+#endif
+
 #ifndef LOGGER_INCLUDED
 	#define LOGGER_INCLUDED
 	#include "logger/logger.h"
@@ -57,6 +92,21 @@ void initEngine( PlaydateAPI* );
 void updateEngine( float );
 void shutdownEngine( void );
 
+// Run game->update at a fixed rate, independent of the frame rate
+//
+// Each frame, update is called as many times as fit in the time since the 
+// last frame (up to maxCatchUpSteps), always with step as its delta. draw 
+// is then called once with the fraction of a step left over, to 
+// interpolate between the last two updates. Pass 0 to go back to one 
+// update per frame with a variable delta.
+//
+// ----
+//
+// float step - The update interval, in seconds. e.g. 1.0f / 30.0f
+//
+// int maxCatchUpSteps - The most updates to run in a single frame
+void setFixedTimestep( float, int );
+
 extern const PlaydateAPI *pd;
 extern const struct playdate_graphics *graphics;
 extern const struct playdate_sound *sound;
@@ -6,6 +6,18 @@
 #include "../prismatic.h"
 #include "scene.h"
 
+// Milliseconds per update spent loading Scenes, unless set otherwise
+#define SCENE_PRELOAD_BUDGET 4
+
+// Size of an activation grid cell, in pixels. Coarse on purpose, so moving 
+// Sprites rarely change cells.
+#define SCENE_ACTIVATION_CELL 128
+// Number of activation grid buckets, must be a power of two
+#define SCENE_ACTIVATION_BUCKETS 64
+// Distance around the camera that NearCamera Sprites stay awake, unless set
+// otherwise
+#define SCENE_ACTIVATION_MARGIN 64.0f
+
 // Scene Manager
 
 static SceneManager* newSceneManager( Scene* );
@@ -20,8 +32,30 @@ static void addScene( SceneManager* sceneManager, Scene* scene );
 static void removeScene( SceneManager* sceneManager, Scene* scene );
 static void removeSceneByName( SceneManager* sceneManager, string sceneName );
 static Scene* getScene( SceneManager* sceneManager, string sceneName );
+static void addPersistentSprite( SceneManager* sceneManager, PrismSprite* sp );
+static void removePersistentSprite( SceneManager* sceneManager, PrismSprite* sp );
+static Scene* pushScene( SceneManager* sceneManager, Scene* overlay, bool freezeBelow );
+static Scene* popScene( SceneManager* sceneManager );
+static void preloadScene( SceneManager* sceneManager, Scene* scene );
+static void setPreloadBudget( SceneManager* sceneManager, unsigned int budget );
+static void runPreload( SceneManager* sceneManager );
+static void dequeuePreload( SceneManager* sceneManager, Scene* scene );
+static bool isSceneReady( Scene* scene );
+static void registerScene( SceneManager* sceneManager, string sceneName, Scene* ( *build )( void ), bool disposable );
+static Scene* buildScene( SceneManager* sceneManager, string sceneName );
+static void queueDisposal( SceneManager* sceneManager, Scene* scene );
+static void disposeScenes( SceneManager* sceneManager );
+static bool sceneHasSprite( Scene* scene, PrismSprite* sp );
+static bool stackHasSprite( SceneManager* sceneManager, size_t depth, PrismSprite* sp );
+static void updateScene( Scene* scene, float delta );
 static void deleteScene( Scene* scene );
-static void addSprite( Scene* scene, string id, PrismSprite* sp );
+static void resumeCoroutines( Scene* scene, float delta );
+static void stopCoroutines( Scene* scene );
+static void updateGroups( Scene* scene, float delta );
+static void updateActivation( Scene* scene );
+static void gridMove( Scene* scene, PrismSprite* sp );
+static PrismSpriteHandle addSprite( Scene* scene, string id, PrismSprite* sp );
+static PrismSprite* resolveSprite( Scene* scene, PrismSpriteHandle handle );
 
 static SceneManager* newSceneManager( Scene* defaultScene ) {
 	
@@ -31,6 +65,18 @@ static SceneManager* newSceneManager( Scene* defaultScene ) {
 		return NULL;
 	}
 
+	sceneManager->_sceneIndex = prismaticHashMap->new( 0 );
+	sceneManager->_factoryIndex = prismaticHashMap->new( 0 );
+	if( sceneManager->_sceneIndex == NULL || sceneManager->_factoryIndex == NULL ) {
+		prismaticLogger->error( "Could not allocate memory for scene manager index" );
+		prismaticHashMap->delete( sceneManager->_sceneIndex );
+		prismaticHashMap->delete( sceneManager->_factoryIndex );
+		free( sceneManager );
+		return NULL;
+	}
+
+	sceneManager->preloadBudget = SCENE_PRELOAD_BUDGET;
+
 	if( defaultScene != NULL ) {
 		sceneManager->defaultScene = defaultScene;
 		addScene( sceneManager, defaultScene );
@@ -55,8 +101,41 @@ static void deleteSceneManager( SceneManager* sceneManager ) {
 		deleteScene( s );
 	}
 
-	sceneManager->scenes = sys->realloc( sceneManager->scenes, 0 );
+	for( size_t i = 0; i < sceneManager->totalPersistentSprites; i++ ) {
+		PrismSprite* sp = sceneManager->persistentSprites[i];
+		sp->_persistent = false;
+		prismaticSprite->delete( sp );
+	}
+
+	sceneManager->persistentSprites = prismaticArray->release( sceneManager->persistentSprites, &sceneManager->_persistentCapacity );
+	sceneManager->totalPersistentSprites = 0;
+
+	sceneManager->scenes = prismaticArray->release( sceneManager->scenes, &sceneManager->_sceneCapacity );
 	sceneManager->totalScenes = 0;
+
+	sceneManager->sceneStack = prismaticArray->release( sceneManager->sceneStack, &sceneManager->_stackCapacity );
+	sceneManager->stackSize = 0;
+
+	sceneManager->_preloadQueue = prismaticArray->release( sceneManager->_preloadQueue, &sceneManager->_preloadCapacity );
+	sceneManager->_preloadCount = 0;
+
+	// Queued Scenes are still in sceneManager->scenes, so were deleted above
+	sceneManager->_disposeQueue = prismaticArray->release( sceneManager->_disposeQueue, &sceneManager->_disposeCapacity );
+	sceneManager->_disposeCount = 0;
+
+	for( size_t i = 0; i < sceneManager->_factoryCount; i++ ) {
+		prismaticString->delete( sceneManager->_factories[i]->name );
+		free( sceneManager->_factories[i] );
+	}
+
+	sceneManager->_factories = prismaticArray->release( sceneManager->_factories, &sceneManager->_factoryCapacity );
+	sceneManager->_factoryCount = 0;
+
+	prismaticHashMap->delete( sceneManager->_factoryIndex );
+	sceneManager->_factoryIndex = NULL;
+
+	prismaticHashMap->delete( sceneManager->_sceneIndex );
+	sceneManager->_sceneIndex = NULL;
 	
 	free( sceneManager );
 	sceneManager = NULL;
@@ -65,20 +144,28 @@ static void deleteSceneManager( SceneManager* sceneManager ) {
 
 static void updateSceneManager( SceneManager* sceneManager, float delta ) {
 
+	disposeScenes( sceneManager );
+	runPreload( sceneManager );
+
 	if( sceneManager->currentScene == NULL ) {
 		return;
 	}
 
-	if( sceneManager->currentScene->update == NULL ) {
-		prismaticLogger->errorf( "Scene '%s' has NULL update function", sceneManager->currentScene->name );
-	} else {
-		sceneManager->currentScene->update( sceneManager->currentScene, delta );
+	// Find the lowest Scene on the stack that is not frozen by an overlay
+	size_t first = sceneManager->stackSize - 1;
+	while( first > 0 && !sceneManager->sceneStack[first]->_freezesBelow ) {
+		first--;
 	}
 
-	// Run the update method for each of the Scene's sprites
-	for( size_t i = 0; i < sceneManager->currentScene->totalSprites; i++ ) {
-		
-		PrismSprite* sp = sceneManager->currentScene->sprites[i];
+	// An update may push or pop Scenes, so re-check the stack each time
+	for( size_t i = first; i < sceneManager->stackSize; i++ ) {
+		updateScene( sceneManager->sceneStack[i], delta );
+	}
+
+	for( size_t i = sceneManager->totalPersistentSprites; i-- > 0; ) {
+
+		PrismSprite* sp = sceneManager->persistentSprites[i];
+		sp->_updating = true;
 
 		if( sp->update == NULL ) {
 			continue;
@@ -88,35 +175,94 @@ static void updateSceneManager( SceneManager* sceneManager, float delta ) {
 
 	}
 
+	prismaticAnimation->tickAll( delta );
+
 }
 
-static void drawSceneManager( SceneManager* sceneManager, float delta ) {
+static void updateScene( Scene* scene, float delta ) {
 
-	if( sceneManager->currentScene == NULL ) {
+	if( scene->update == NULL ) {
+		prismaticLogger->errorf( "Scene '%s' has NULL update function", scene->name );
+	} else {
+		scene->update( scene, delta );
+	}
+
+	updateActivation( scene );
+	updateGroups( scene, delta );
+
+	// Run the update method for each of the Scene's ungrouped, awake sprites,
+	// in order. Removing a Sprite moves another into its place, so walk 
+	// handles taken up front instead of the array. Sprites removed during the
+	// pass are skipped, Sprites added during it wait for the next update.
+	size_t count = scene->totalSprites;
+
+	PrismSpriteHandle* order = prismaticArray->reserve( scene->_updateOrder, &scene->_updateCapacity, count, sizeof( PrismSpriteHandle ) );
+	if( order == NULL ) {
+		prismaticLogger->errorf( "Memory allocation failed for Scene '%s' update order", scene->name );
+		resumeCoroutines( scene, delta );
 		return;
 	}
 
-	if( sceneManager->currentScene->draw == NULL ) {
-		prismaticLogger->errorf( "Scene '%s' has NULL draw function", sceneManager->currentScene->name );
-	} else {
-		sceneManager->currentScene->draw( sceneManager->currentScene, delta );
+	scene->_updateOrder = order;
+
+	for( size_t i = 0; i < count; i++ ) {
+		uint32_t slot = scene->_spriteSlots[i];
+		order[i] = (PrismSpriteHandle){ .slot = slot, .generation = scene->_slots[slot].generation };
 	}
 
+	for( size_t i = 0; i < count; i++ ) {
+		
+		PrismSprite* sp = resolveSprite( scene, scene->_updateOrder[i] );
+
+		if( sp == NULL || sp->dormant ) {
+			continue;
+		}
+
+		// Grouped Sprites and those without an update still animate
+		sp->_updating = true;
+
+		if( sp->update == NULL || sp->group != NULL ) {
+			continue;
+		}
+
+		sp->update( sp, delta );
+
+	}
+
+	resumeCoroutines( scene, delta );
+
 }
 
-static Scene* changeSceneByName( SceneManager* sceneManager, string name ) {
+static void drawSceneManager( SceneManager* sceneManager, float delta ) {
 
-	Scene* scene = NULL;
+	// Draw from the base Scene up, so overlays end up on top
+	for( size_t i = 0; i < sceneManager->stackSize; i++ ) {
 
-	for( size_t i = 0; i < sceneManager->totalScenes; i++ ) {
-		Scene* s = sceneManager->scenes[i];
-		if( strcmp( s->name, name ) == 0 ) {
-			scene = changeScene( sceneManager, s );
-			break;
+		Scene* scene = sceneManager->sceneStack[i];
+
+		if( scene->draw == NULL ) {
+			prismaticLogger->errorf( "Scene '%s' has NULL draw function", scene->name );
+			continue;
 		}
+
+		scene->draw( scene, delta );
+
 	}
 
-	return scene;
+}
+
+static Scene* changeSceneByName( SceneManager* sceneManager, string name ) {
+
+	Scene* scene = prismaticHashMap->get( sceneManager->_sceneIndex, name );
+	if( scene == NULL ) {
+		scene = buildScene( sceneManager, name );
+	}
+
+	if( scene == NULL ) {
+		return NULL;
+	}
+
+	return changeScene( sceneManager, scene );
 
 }
 
@@ -132,29 +278,69 @@ static Scene* changeScene( SceneManager* sceneManager, Scene* scene ) {
 		return NULL;
 	}
 
-	if( sceneManager->currentScene != NULL ) {
+	if( !isSceneReady( scene ) ) {
+		prismaticLogger->errorf( "Cannot change to Scene '%s' before it has loaded", scene->name );
+		return NULL;
+	}
+
+	Scene** stack = prismaticArray->reserve( sceneManager->sceneStack, &sceneManager->_stackCapacity, 1, sizeof( Scene* ) );
+	if( stack == NULL ) {
+		prismaticLogger->error( "Memory allocation failed for scene stack." );
+		return NULL;
+	}
+
+	sceneManager->sceneStack = stack;
+
+	// Overlays belong to the base Scene being replaced
+	while( sceneManager->stackSize > 1 ) {
+		popScene( sceneManager );
+	}
+
+	Scene* outgoing = sceneManager->currentScene;
+
+	if( outgoing != NULL ) {
 		
-		if( sceneManager->currentScene->exit != NULL ) {
-			sceneManager->currentScene->exit( sceneManager->currentScene );
+		if( outgoing->exit != NULL ) {
+			outgoing->exit( outgoing );
+		}
+
+		outgoing->isActive = false;
+		stopCoroutines( outgoing );
+
+		if( outgoing->disposable && outgoing != scene ) {
+			queueDisposal( sceneManager, outgoing );
 		}
 
-		sceneManager->currentScene->isActive = false;
+		// Remove only the Sprites that the incoming Scene does not share
+		for( size_t i = 0; i < outgoing->totalSprites; i++ ) {
 
-		// Remove any active sprites from the screen
-		sprites->removeAllSprites();
+			PrismSprite* sp = outgoing->sprites[i];
+			if( sp->_persistent || sceneHasSprite( scene, sp ) ) {
+				continue;
+			}
+
+			sprites->removeSprite( sp->sprite );
+
+		}
 
-		sceneManager->previousScene = sceneManager->currentScene;
+		sceneManager->previousScene = outgoing;
 
 	}
 
 	sceneManager->currentScene = scene;
+	sceneManager->sceneStack[0] = scene;
+	sceneManager->stackSize = 1;
+
+	// Add the incoming Scene's Sprites that are not already on screen
+	for( size_t i = 0; i < scene->totalSprites; i++ ) {
 
-	// Add Sprites from current Scene
-	if( sceneManager->currentScene->sprites != NULL ) {
-		size_t i = 0;
-		for( i = 0; sceneManager->currentScene->sprites[i] != NULL; i++ ) {
-			sprites->addSprite( sceneManager->currentScene->sprites[i]->sprite );
+		PrismSprite* sp = scene->sprites[i];
+		if( sp->_persistent || ( outgoing != NULL && sceneHasSprite( outgoing, sp ) ) ) {
+			continue;
 		}
+
+		sprites->addSprite( sp->sprite );
+
 	}
 
 	sceneManager->currentScene->isActive = true;
@@ -188,16 +374,34 @@ static void addScene( SceneManager* sceneManager, Scene* scene ) {
 		return;
 	}
 
-	sceneManager->totalScenes++;
-	sceneManager->scenes = sys->realloc( sceneManager->scenes, sceneManager->totalScenes * sizeof(Scene) + 1 );
+	Scene* existing = prismaticHashMap->get( sceneManager->_sceneIndex, scene->name );
+	if( existing != NULL ) {
+
+		if( existing != scene ) {
+			prismaticLogger->errorf( "A different Scene named '%s' is already in the SceneManager", scene->name );
+		}
+
+		return;
+
+	}
+
+	if( !prismaticHashMap->set( sceneManager->_sceneIndex, scene->name, scene ) ) {
+		prismaticLogger->errorf( "Could not index scene: %s", scene->name );
+		return;
+	}
+
+	Scene** scenes = prismaticArray->reserve( sceneManager->scenes, &sceneManager->_sceneCapacity, sceneManager->totalScenes + 2, sizeof( Scene* ) );
 
-	if (sceneManager->scenes == NULL) {
+	if (scenes == NULL) {
         prismaticLogger->errorf( "Memory allocation failed for adding scene: %s", scene->name );
+        prismaticHashMap->remove( sceneManager->_sceneIndex, scene->name );
         return;
     }
 
     scene->sceneManager = sceneManager;
     
+    sceneManager->scenes = scenes;
+    sceneManager->totalScenes++;
     sceneManager->scenes[sceneManager->totalScenes - 1] = scene;
     sceneManager->scenes[sceneManager->totalScenes] = NULL;
 
@@ -215,27 +419,30 @@ static void removeScene( SceneManager* sceneManager, Scene* scene ) {
 		return;
 	}
 		
-	if( prismaticString->equals( scene->name, sceneManager->currentScene->name ) ) {
-		prismaticLogger->infof( "Cannot remove current Scene from SceneManager" );
-		return;
+	for( size_t i = 0; i < sceneManager->stackSize; i++ ) {
+		if( sceneManager->sceneStack[i] == scene ) {
+			prismaticLogger->infof( "Cannot remove current Scene from SceneManager" );
+			return;
+		}
+	}
+
+	if( prismaticHashMap->get( sceneManager->_sceneIndex, scene->name ) != scene ) {
+        prismaticLogger->errorf( "Did not find Scene %s in SceneManager!", scene->name );
+        return;
 	}
 
+	prismaticHashMap->remove( sceneManager->_sceneIndex, scene->name );
+	dequeuePreload( sceneManager, scene );
+
 	size_t i = 0;
 	for( i = 0; sceneManager->scenes[i] != NULL; i++ ) {
 		
-		if( strcmp( scene->name, sceneManager->scenes[i]->name ) != 0 ) {
-			continue;
+		if( sceneManager->scenes[i] == scene ) {
+			break;
 		}
 
-		break;
-
 	}
 
-    if( sceneManager->scenes[i] == NULL ) {
-        prismaticLogger->errorf( "Did not find Scene %d in SceneManager!", scene->name );
-        return;
-    }
-
     // Shift Scenes to remove Scene at i 
     for( size_t j = i; sceneManager->scenes[j] != NULL; j++ ) {
         sceneManager->scenes[j] = sceneManager->scenes[j + 1];
@@ -247,7 +454,8 @@ static void removeScene( SceneManager* sceneManager, Scene* scene ) {
 
 static void removeSceneByName( SceneManager* sceneManager, string sceneName ) {
 
-	Scene* scene = getScene( sceneManager, sceneName );
+	// getScene would build a registered Scene only to remove and leak it
+	Scene* scene = prismaticHashMap->get( sceneManager->_sceneIndex, sceneName );
 	if( scene == NULL ) {
 		return;
 	}
@@ -258,205 +466,1395 @@ static void removeSceneByName( SceneManager* sceneManager, string sceneName ) {
 
 static Scene* getScene( SceneManager* sceneManager, string sceneName ) {
 
-	if( sceneManager->scenes == NULL ) {
-		prismaticLogger->infof( "Scenes NULL when getting Scene '%s'", sceneName );
-		return NULL;
+	Scene* scene = prismaticHashMap->get( sceneManager->_sceneIndex, sceneName );
+	if( scene == NULL ) {
+		scene = buildScene( sceneManager, sceneName );
 	}
 
-	size_t i = 0;
-	for( i = 0; sceneManager->scenes[i] != NULL; i++ ) {
-
-		if( strcmp( sceneManager->scenes[i]->name, sceneName ) != 0 ) {
-			continue;
-		}
-
-		return sceneManager->scenes[i];
-
+	if( scene == NULL ) {
+		prismaticLogger->infof( "Scene id '%s' not found in SceneManager", sceneName );
 	}
 
-	prismaticLogger->infof( "Scene id '%s' not found in SceneManager", sceneName );
-	return NULL;
+	return scene;
 
 }
 
-const SceneManagerFn* prismaticSceneManager = &(SceneManagerFn){
-	.new = newSceneManager,
-	.delete = deleteSceneManager,
-	.update = updateSceneManager,
-	.draw = drawSceneManager,
-	.changeSceneByName = changeSceneByName,
-	.changeScene = changeScene,
-	.changeToPrevious = changeToPrevious,
-	.changeToDefault = changeToDefault,
-	.add = addScene,
-	.remove = removeScene,
-	.removeByName = removeSceneByName,
-	.get = getScene,
-}; 
-
-// Scene
+static void addPersistentSprite( SceneManager* sceneManager, PrismSprite* sp ) {
 
-// Creates a new Scene with the given name
-static Scene* newScene( string name ) {
+	if( sp == NULL ) {
+		prismaticLogger->info( "Cannot add NULL persistent Sprite to SceneManager" );
+		return;
+	}
 
-	if( name == NULL ) {
-		prismaticLogger->error( "Cannot create new scene with NULL name" );
-		return NULL;
+	if( sp->_persistent ) {
+		return;
 	}
 
-	Scene* scene = calloc( 1, sizeof(Scene) );
-	if( scene == NULL ) {
-		prismaticLogger->error( "Could not allocate memory for new scene" );
-		return NULL;
+	PrismSprite** persistentSprites = prismaticArray->reserve( sceneManager->persistentSprites, &sceneManager->_persistentCapacity, sceneManager->totalPersistentSprites + 2, sizeof( PrismSprite* ) );
+	if( persistentSprites == NULL ) {
+		prismaticLogger->error( "Memory allocation failed for adding persistent sprite." );
+		return;
 	}
 
-	scene->name = name;
+	sceneManager->persistentSprites = persistentSprites;
+	sceneManager->totalPersistentSprites++;
+	sceneManager->persistentSprites[sceneManager->totalPersistentSprites - 1] = sp;
+	sceneManager->persistentSprites[sceneManager->totalPersistentSprites] = NULL;
 
-	return scene;
+	sp->_persistent = true;
+	sprites->addSprite( sp->sprite );
 
 }
 
-// Deletes the Scene and performs clean up operations
-//  
-// First, scene->destroy() is called, if it is set. Next, all sprites are 
-// destroyed with prismaticSprite->delete() and the sprites pointer is freed. Finally, the Scene is freed.
-static void deleteScene( Scene* scene ) {
+static void removePersistentSprite( SceneManager* sceneManager, PrismSprite* sp ) {
 
-	if( scene->destroy != NULL ) {
-		scene->destroy( scene );
+	if( sp == NULL || !sp->_persistent ) {
+		prismaticLogger->info( "Cannot remove a Sprite that is not persistent from SceneManager" );
+		return;
 	}
 
-	if( scene->sprites != NULL ) {
+	for( size_t i = 0; i < sceneManager->totalPersistentSprites; i++ ) {
 
-		for( size_t i = 0; scene->sprites[i] != NULL; i++ ) {
-			prismaticSprite->delete( scene->sprites[i] );
+		if( sceneManager->persistentSprites[i] != sp ) {
+			continue;
 		}
 
-		scene->sprites = sys->realloc( scene->sprites, 0 );
-		scene->sprites = NULL;
-		scene->totalSprites = 0;
+		size_t last = sceneManager->totalPersistentSprites - 1;
+		sceneManager->persistentSprites[i] = sceneManager->persistentSprites[last];
+		sceneManager->persistentSprites[last] = NULL;
+		sceneManager->totalPersistentSprites--;
 
-	}
+		sp->_persistent = false;
 
-	free( scene );
-	scene = NULL;
+		// Keep the Sprite on screen if the current Scene also holds it
+		if( sceneManager->currentScene == NULL || !sceneHasSprite( sceneManager->currentScene, sp ) ) {
+			sprites->removeSprite( sp->sprite );
+		}
+
+		return;
+
+	}
 
 }
 
-// Adds a Sprite to the Scene. spriteId should be a unique identifier within 
-// this Scene.
-static void addSprite( Scene* scene, string spriteId, PrismSprite* sp ) {
+static Scene* pushScene( SceneManager* sceneManager, Scene* overlay, bool freezeBelow ) {
 
-	if( scene == NULL ) {
-		prismaticLogger->info( "Cannot add Sprite to NULL Scene" );
-		return;
+	if( overlay == NULL ) {
+		prismaticLogger->error( "Cannot push NULL overlay Scene" );
+		return NULL;
 	}
 
-	if( spriteId == NULL ) {
-		prismaticLogger->info( "Cannot add sprite without id" );
-		return;
+	if( sceneManager->currentScene == NULL ) {
+		return changeScene( sceneManager, overlay );
 	}
 
-	if( sp == NULL ) {
-		prismaticLogger->info( "Cannot add NULL Sprite to Scene" );
-		return;
+	if( !isSceneReady( overlay ) ) {
+		prismaticLogger->errorf( "Cannot push Scene '%s' before it has loaded", overlay->name );
+		return NULL;
 	}
 
-	if( scene->sprites != NULL ) {
-		size_t i = 0;
-		for( i = 0; scene->sprites[i] != NULL; i++ ) {
+	for( size_t i = 0; i < sceneManager->stackSize; i++ ) {
+		if( sceneManager->sceneStack[i] == overlay ) {
+			prismaticLogger->errorf( "Scene '%s' is already on the scene stack", overlay->name );
+			return NULL;
+		}
+	}
 
-			if( !prismaticString->equals( spriteId, scene->sprites[i]->id ) ) {
-				continue;
-			}
+	Scene** stack = prismaticArray->reserve( sceneManager->sceneStack, &sceneManager->_stackCapacity, sceneManager->stackSize + 1, sizeof( Scene* ) );
+	if( stack == NULL ) {
+		prismaticLogger->error( "Memory allocation failed for scene stack." );
+		return NULL;
+	}
 
-			return;
+	sceneManager->sceneStack = stack;
 
+	// addScene logs why it could not add the overlay, such as a different 
+	// Scene already having its name
+	addScene( sceneManager, overlay );
+	if( prismaticHashMap->get( sceneManager->_sceneIndex, overlay->name ) != overlay ) {
+		return NULL;
+	}
+
+	// Add the overlay's Sprites that are not already on screen
+	for( size_t i = 0; i < overlay->totalSprites; i++ ) {
+
+		PrismSprite* sp = overlay->sprites[i];
+		if( sp->_persistent || stackHasSprite( sceneManager, sceneManager->stackSize, sp ) ) {
+			continue;
 		}
+
+		sprites->addSprite( sp->sprite );
+
 	}
 
-	scene->totalSprites += 1;
-	scene->sprites = sys->realloc( scene->sprites, scene->totalSprites * sizeof(PrismSprite*) + 1 );
+	overlay->_freezesBelow = freezeBelow;
+	overlay->isActive = true;
 
-	if( scene->sprites == NULL ) {
-        prismaticLogger->error( "Memory allocation failed for adding sprite." );
-        return;
-    }
+	sceneManager->sceneStack[sceneManager->stackSize++] = overlay;
+	sceneManager->currentScene = overlay;
 
-    sp->id = prismaticString->new( spriteId );
-    scene->sprites[scene->totalSprites - 1] = sp;
-    scene->sprites[scene->totalSprites] = NULL;
+	if( overlay->enter != NULL ) {
+		overlay->enter( overlay );
+	}
 
-    if( scene->isActive ) {
-		sprites->addSprite( sp->sprite );
-    }
+	return overlay;
 
 }
 
-// Removes the Sprite from the Scene. Does not delete the Sprite. The caller
-// is responsible for calling prismaticSprite->delete() when a Sprite is 
-// removed in this way.
-static void removeSprite( Scene* scene, PrismSprite* sp ) {
+static Scene* popScene( SceneManager* sceneManager ) {
 
-	if( scene == NULL ) {
-		prismaticLogger->info( "Cannot remove Sprite from NULL Scene" );
-		return;
+	if( sceneManager->stackSize <= 1 ) {
+		prismaticLogger->info( "No overlay Scene to pop" );
+		return NULL;
 	}
 
-	if( sp == NULL ) {
-		prismaticLogger->info( "Cannot remove NULL Sprite from Scene" );
-		return;
+	Scene* overlay = sceneManager->sceneStack[sceneManager->stackSize - 1];
+
+	if( overlay->exit != NULL ) {
+		overlay->exit( overlay );
 	}
 
-	if( scene->sprites != NULL ) {		
-		size_t i = 0;
-		for( i = 0; scene->sprites[i] != NULL; i++ ) {
-			
-			if( strcmp( sp->id, scene->sprites[i]->id ) != 0 ) {
-				continue;
-			}
+	overlay->isActive = false;
+	overlay->_freezesBelow = false;
+	stopCoroutines( overlay );
 
-			sprites->removeSprite( scene->sprites[i]->sprite );
-			break;
+	if( overlay->disposable ) {
+		queueDisposal( sceneManager, overlay );
+	}
 
-		}
+	sceneManager->stackSize--;
+	sceneManager->sceneStack[sceneManager->stackSize] = NULL;
+	sceneManager->currentScene = sceneManager->sceneStack[sceneManager->stackSize - 1];
+
+	// Remove only the Sprites that the Scenes below do not share
+	for( size_t i = 0; i < overlay->totalSprites; i++ ) {
 
-	    if( scene->sprites[i] == NULL ) {
-	        prismaticLogger->errorf( "Did not find Sprite %d in Scene!", sp->id );
-	        return;
-	    }
+		PrismSprite* sp = overlay->sprites[i];
+		if( sp->_persistent || stackHasSprite( sceneManager, sceneManager->stackSize, sp ) ) {
+			continue;
+		}
 
-	    // Shift sprites to remove Sprite at i 
-	    for( size_t j = i; scene->sprites[j] != NULL; j++ ) {
-	        scene->sprites[j] = scene->sprites[j + 1];
-	    }
+		sprites->removeSprite( sp->sprite );
 
-	    scene->totalSprites--;
 	}
 
+	return sceneManager->currentScene;
+
 }
 
+static void preloadScene( SceneManager* sceneManager, Scene* scene ) {
 
-PrismSprite* getSprite( Scene* scene, string spriteId ) {
+	if( scene == NULL ) {
+		prismaticLogger->info( "Not preloading NULL scene" );
+		return;
+	}
 
-	if( scene->sprites == NULL ) {
-		prismaticLogger->infof( "Scene sprites NULL when getting sprite '%s'", spriteId );
-		return NULL;
+	if( isSceneReady( scene ) ) {
+		return;
 	}
 
-	size_t i = 0;
-	for( i = 0; scene->sprites[i] != NULL; i++ ) {
-		
-		if( !prismaticString->equals( spriteId, scene->sprites[i]->id ) ) {
-			continue;
+	for( size_t i = 0; i < sceneManager->_preloadCount; i++ ) {
+		if( sceneManager->_preloadQueue[i] == scene ) {
+			return;
 		}
+	}
 
-		return scene->sprites[i];
-
+	Scene** queue = prismaticArray->reserve( sceneManager->_preloadQueue, &sceneManager->_preloadCapacity, sceneManager->_preloadCount + 1, sizeof( Scene* ) );
+	if( queue == NULL ) {
+		prismaticLogger->error( "Memory allocation failed for scene preload queue." );
+		return;
 	}
 
-	prismaticLogger->infof( "Sprite id '%s' not found in Scene", spriteId );
-	return NULL;
+	sceneManager->_preloadQueue = queue;
+	addScene( sceneManager, scene );
+
+	sceneManager->_preloadQueue[sceneManager->_preloadCount++] = scene;
+	scene->loadState = SceneLoadState_Loading;
+
+}
+
+static void setPreloadBudget( SceneManager* sceneManager, unsigned int budget ) {
+	sceneManager->preloadBudget = budget;
+}
+
+// Run load steps for the queued Scenes, oldest first, until the queue is 
+// empty or the budget is spent. Scenes whose load function reports failure
+// leave the queue. A step is never interrupted, so a slow step
+// can overrun the budget.
+static void runPreload( SceneManager* sceneManager ) {
+
+	if( sceneManager->_preloadCount == 0 ) {
+		return;
+	}
+
+	unsigned int start = sys->getCurrentTimeMilliseconds();
+
+	do {
+
+		Scene* scene = sceneManager->_preloadQueue[0];
+
+		if( scene->load( scene ) ) {
+			scene->loadState = SceneLoadState_Ready;
+			dequeuePreload( sceneManager, scene );
+			prismaticLogger->infof( "Scene '%s' loaded", scene->name );
+		} else if( scene->loadState == SceneLoadState_Failed ) {
+			dequeuePreload( sceneManager, scene );
+			prismaticLogger->errorf( "Scene '%s' failed to load", scene->name );
+		}
+
+	} while( 
+		sceneManager->_preloadCount > 0 
+		&& sys->getCurrentTimeMilliseconds() - start < sceneManager->preloadBudget 
+	);
+
+}
+
+static void dequeuePreload( SceneManager* sceneManager, Scene* scene ) {
+
+	for( size_t i = 0; i < sceneManager->_preloadCount; i++ ) {
+
+		if( sceneManager->_preloadQueue[i] != scene ) {
+			continue;
+		}
+
+		// Shift the queue to keep it in preload order
+		for( size_t j = i; j + 1 < sceneManager->_preloadCount; j++ ) {
+			sceneManager->_preloadQueue[j] = sceneManager->_preloadQueue[j + 1];
+		}
+
+		sceneManager->_preloadCount--;
+		return;
+
+	}
+
+}
+
+static void registerScene( SceneManager* sceneManager, string sceneName, Scene* ( *build )( void ), bool disposable ) {
+
+	if( sceneName == NULL || build == NULL ) {
+		prismaticLogger->error( "Cannot register a Scene factory without a name and build function" );
+		return;
+	}
+
+	if( prismaticHashMap->get( sceneManager->_factoryIndex, sceneName ) != NULL ) {
+		prismaticLogger->errorf( "A Scene factory named '%s' is already registered", sceneName );
+		return;
+	}
+
+	SceneFactory** factories = prismaticArray->reserve( sceneManager->_factories, &sceneManager->_factoryCapacity, sceneManager->_factoryCount + 1, sizeof( SceneFactory* ) );
+	if( factories == NULL ) {
+		prismaticLogger->error( "Memory allocation failed for scene factories." );
+		return;
+	}
+
+	sceneManager->_factories = factories;
+
+	SceneFactory* factory = calloc( 1, sizeof( SceneFactory ) );
+	if( factory == NULL ) {
+		prismaticLogger->error( "Could not allocate memory for scene factory" );
+		return;
+	}
+
+	factory->name = prismaticString->new( sceneName );
+	factory->build = build;
+	factory->disposable = disposable;
+
+	if( !prismaticHashMap->set( sceneManager->_factoryIndex, factory->name, factory ) ) {
+		prismaticString->delete( factory->name );
+		free( factory );
+		return;
+	}
+
+	sceneManager->_factories[sceneManager->_factoryCount++] = factory;
+
+}
+
+// Build the named Scene from its factory and add it to the SceneManager. 
+// Returns NULL if no factory is registered under the name.
+static Scene* buildScene( SceneManager* sceneManager, string sceneName ) {
+
+	SceneFactory* factory = prismaticHashMap->get( sceneManager->_factoryIndex, sceneName );
+	if( factory == NULL ) {
+		return NULL;
+	}
+
+	Scene* scene = factory->build();
+	if( scene == NULL ) {
+		prismaticLogger->errorf( "Scene factory '%s' did not build a Scene", sceneName );
+		return NULL;
+	}
+
+	if( !prismaticString->equals( scene->name, factory->name ) ) {
+		prismaticLogger->errorf( "Scene factory '%s' built a Scene named '%s'", factory->name, scene->name );
+		deleteScene( scene );
+		return NULL;
+	}
+
+	scene->disposable = factory->disposable;
+	addScene( sceneManager, scene );
+
+	return scene;
+
+}
+
+static void queueDisposal( SceneManager* sceneManager, Scene* scene ) {
+
+	for( size_t i = 0; i < sceneManager->_disposeCount; i++ ) {
+		if( sceneManager->_disposeQueue[i] == scene ) {
+			return;
+		}
+	}
+
+	Scene** queue = prismaticArray->reserve( sceneManager->_disposeQueue, &sceneManager->_disposeCapacity, sceneManager->_disposeCount + 1, sizeof( Scene* ) );
+	if( queue == NULL ) {
+		prismaticLogger->errorf( "Memory allocation failed for scene dispose queue, keeping '%s'", scene->name );
+		return;
+	}
+
+	sceneManager->_disposeQueue = queue;
+	sceneManager->_disposeQueue[sceneManager->_disposeCount++] = scene;
+
+}
+
+// Delete the disposable Scenes that have exited. This is deferred to the 
+// next update since a Scene usually changes away from itself in one of its 
+// own callbacks.
+static void disposeScenes( SceneManager* sceneManager ) {
+
+	for( size_t i = 0; i < sceneManager->_disposeCount; i++ ) {
+
+		Scene* scene = sceneManager->_disposeQueue[i];
+
+		// Changed back to before it could be released, or removed from the
+		// SceneManager by the caller who now owns it
+		if( scene->isActive || prismaticHashMap->get( sceneManager->_sceneIndex, scene->name ) != scene ) {
+			continue;
+		}
+
+		removeScene( sceneManager, scene );
+
+		if( sceneManager->defaultScene == scene ) {
+			sceneManager->defaultScene = NULL;
+		}
+
+		if( sceneManager->previousScene == scene ) {
+			sceneManager->previousScene = NULL;
+		}
+
+		deleteScene( scene );
+
+	}
+
+	sceneManager->_disposeCount = 0;
+
+}
+
+const SceneManagerFn* prismaticSceneManager = &(SceneManagerFn){
+	.new = newSceneManager,
+	.delete = deleteSceneManager,
+	.update = updateSceneManager,
+	.draw = drawSceneManager,
+	.changeSceneByName = changeSceneByName,
+	.changeScene = changeScene,
+	.changeToPrevious = changeToPrevious,
+	.changeToDefault = changeToDefault,
+	.add = addScene,
+	.remove = removeScene,
+	.removeByName = removeSceneByName,
+	.get = getScene,
+	.addPersistent = addPersistentSprite,
+	.removePersistent = removePersistentSprite,
+	.push = pushScene,
+	.pop = popScene,
+	.preload = preloadScene,
+	.setPreloadBudget = setPreloadBudget,
+	.registerScene = registerScene,
+}; 
+
+// Scene
+
+#define SCENE_NO_SLOT UINT32_MAX
+
+static bool reserveSprites( Scene* scene );
+static void* slotToValue( uint32_t slot );
+static uint32_t valueToSlot( void* value );
+static PrismSpriteHandle getSpriteHandle( Scene* scene, string spriteId );
+static bool isValidSprite( Scene* scene, PrismSpriteHandle handle );
+static void startSceneCoroutine( Scene* scene, PrismCoroutine* co, bool ( *run )( PrismCoroutine*, float ), void* data );
+static void stopSceneCoroutine( Scene* scene, PrismCoroutine* co );
+static void unlinkCoroutines( Scene* scene );
+static PrismUpdateGroup* joinGroup( Scene* scene, PrismSprite* sp, void ( *update )( PrismUpdateGroup*, float ) );
+static void leaveGroup( Scene* scene, PrismSprite* sp );
+static PrismUpdateGroup* getGroup( Scene* scene, void ( *update )( PrismUpdateGroup*, float ) );
+static PrismUpdateGroup* newGroup( Scene* scene, void ( *update )( PrismUpdateGroup*, float ) );
+static bool reserveGroup( PrismUpdateGroup* group, size_t count );
+static void deleteGroups( Scene* scene );
+static void setActivation( Scene* scene, PrismSprite* sp, PrismActivation activation );
+static void setCamera( Scene* scene, float x, float y, float width, float height );
+static void moveSprite( Scene* scene, PrismSprite* sp, float x, float y );
+static bool gridInsert( Scene* scene, PrismSprite* sp );
+static void gridRemove( Scene* scene, PrismSprite* sp );
+static void removeAwake( Scene* scene, PrismSprite* sp );
+static void deleteActivationGrid( Scene* scene );
+static int32_t activationCell( float position );
+static SceneActivationBucket* activationBucket( Scene* scene, int32_t cellX, int32_t cellY );
+
+// Creates a new Scene with the given name
+static Scene* newScene( string name ) {
+
+	if( name == NULL ) {
+		prismaticLogger->error( "Cannot create new scene with NULL name" );
+		return NULL;
+	}
+
+	Scene* scene = calloc( 1, sizeof(Scene) );
+	if( scene == NULL ) {
+		prismaticLogger->error( "Could not allocate memory for new scene" );
+		return NULL;
+	}
+
+	scene->_spriteIndex = prismaticHashMap->new( 0 );
+	if( scene->_spriteIndex == NULL ) {
+		prismaticLogger->error( "Could not allocate memory for new scene sprite index" );
+		free( scene );
+		return NULL;
+	}
+
+	scene->name = name;
+	scene->_freeSlot = SCENE_NO_SLOT;
+	scene->camera = (PDRect){ 0, 0, LCD_COLUMNS, LCD_ROWS };
+	scene->activationMargin = SCENE_ACTIVATION_MARGIN;
+
+	return scene;
+
+}
+
+// Deletes the Scene and performs clean up operations
+//  
+// First, scene->destroy() is called, if it is set. Next, all sprites are 
+// destroyed with prismaticSprite->delete() and the sprites pointer is freed. Finally, the Scene is freed.
+static void deleteScene( Scene* scene ) {
+
+	// Coroutines are owned by the caller, detach them before destroy can 
+	// free them
+	stopCoroutines( scene );
+
+	if( scene->destroy != NULL ) {
+		scene->destroy( scene );
+	}
+
+	deleteGroups( scene );
+	deleteActivationGrid( scene );
+
+	if( scene->sprites != NULL ) {
+
+		for( size_t i = 0; scene->sprites[i] != NULL; i++ ) {
+
+			PrismSprite* sp = scene->sprites[i];
+
+			// Shared and persistent Sprites are deleted by their last owner, 
+			// pooled Sprites by their pool
+			sp->_sceneRefs--;
+			if( sp->_sceneRefs > 0 || sp->_persistent || sp->pool != NULL ) {
+				continue;
+			}
+
+			prismaticSprite->delete( sp );
+
+		}
+
+		scene->totalSprites = 0;
+
+	}
+
+	size_t spriteCapacity = scene->_spriteCapacity;
+	scene->sprites = prismaticArray->release( scene->sprites, &spriteCapacity );
+	scene->_spriteSlots = prismaticArray->release( scene->_spriteSlots, &scene->_spriteCapacity );
+	scene->_slots = prismaticArray->release( scene->_slots, &scene->_slotCapacity );
+	scene->_slotCount = 0;
+	scene->_updateOrder = prismaticArray->release( scene->_updateOrder, &scene->_updateCapacity );
+
+	prismaticHashMap->delete( scene->_spriteIndex );
+	scene->_spriteIndex = NULL;
+
+	free( scene );
+	scene = NULL;
+
+}
+
+// Adds a Sprite to the Scene. spriteId should be a unique identifier within 
+// this Scene.
+static PrismSpriteHandle addSprite( Scene* scene, string spriteId, PrismSprite* sp ) {
+
+	PrismSpriteHandle handle = { 0 };
+
+	if( scene == NULL ) {
+		prismaticLogger->info( "Cannot add Sprite to NULL Scene" );
+		return handle;
+	}
+
+	if( spriteId == NULL ) {
+		prismaticLogger->info( "Cannot add sprite without id" );
+		return handle;
+	}
+
+	if( sp == NULL ) {
+		prismaticLogger->info( "Cannot add NULL Sprite to Scene" );
+		return handle;
+	}
+
+	if( prismaticHashMap->get( scene->_spriteIndex, spriteId ) != NULL ) {
+		return handle;
+	}
+
+	if( !reserveSprites( scene ) ) {
+        prismaticLogger->error( "Memory allocation failed for adding sprite." );
+        return handle;
+    }
+
+	if( sp->id == NULL || !prismaticString->equals( sp->id, spriteId ) ) {
+
+		// Other Scenes index the Sprite by its current id
+		if( sp->_sceneRefs > 0 ) {
+			prismaticLogger->errorf( "Sprite '%s' is shared, it cannot be added as '%s'", sp->id, spriteId );
+			return handle;
+		}
+
+		prismaticString->delete( sp->id );
+		sp->id = prismaticString->new( spriteId );
+
+	}
+
+	// Reuse a free slot if there is one, otherwise take a new one
+	uint32_t slot = scene->_freeSlot != SCENE_NO_SLOT ? scene->_freeSlot : (uint32_t)scene->_slotCount;
+
+	if( !prismaticHashMap->set( scene->_spriteIndex, sp->id, slotToValue( slot ) ) ) {
+		prismaticLogger->error( "Could not index sprite." );
+		return handle;
+	}
+
+	if( slot == scene->_freeSlot ) {
+		scene->_freeSlot = scene->_slots[slot].index;
+	} else {
+		scene->_slots[slot].generation = 0;
+		scene->_slotCount++;
+	}
+
+	uint32_t index = (uint32_t)scene->totalSprites;
+
+	scene->_slots[slot].generation++;
+	scene->_slots[slot].index = index;
+
+	scene->sprites[index] = sp;
+	scene->_spriteSlots[index] = slot;
+	scene->totalSprites++;
+	scene->sprites[scene->totalSprites] = NULL;
+	sp->_sceneRefs++;
+
+	// A Sprite shared by several Scenes stays in the first Scene's grid
+	if( sp->activation == PrismActivation_NearCamera && sp->_gridScene == NULL ) {
+		gridInsert( scene, sp );
+	}
+
+    if( scene->isActive ) {
+		sprites->addSprite( sp->sprite );
+    }
+
+    handle.slot = slot;
+    handle.generation = scene->_slots[slot].generation;
+
+    return handle;
+
+}
+
+// Removes the Sprite from the Scene. Does not delete the Sprite. The caller
+// is responsible for calling prismaticSprite->delete() when a Sprite is 
+// removed in this way.
+static void removeSprite( Scene* scene, PrismSprite* sp ) {
+
+	if( scene == NULL ) {
+		prismaticLogger->info( "Cannot remove Sprite from NULL Scene" );
+		return;
+	}
+
+	if( sp == NULL ) {
+		prismaticLogger->info( "Cannot remove NULL Sprite from Scene" );
+		return;
+	}
+
+	void* value = sp->id != NULL ? prismaticHashMap->get( scene->_spriteIndex, sp->id ) : NULL;
+	uint32_t slot = valueToSlot( value );
+
+	if( value == NULL || scene->sprites[scene->_slots[slot].index] != sp ) {
+		prismaticLogger->errorf( "Did not find Sprite %s in Scene!", sp->id );
+		return;
+	}
+
+	if( scene->isActive && !sp->_persistent ) {
+		sprites->removeSprite( sp->sprite );
+	}
+
+	if( sp->group != NULL && sp->group->_scene == scene ) {
+		leaveGroup( scene, sp );
+	}
+
+	if( sp->_gridScene == scene ) {
+		gridRemove( scene, sp );
+		sp->dormant = false;
+	}
+
+	prismaticHashMap->remove( scene->_spriteIndex, sp->id );
+	sp->_sceneRefs--;
+
+	// Move the last Sprite into the hole so the array stays dense
+	uint32_t index = scene->_slots[slot].index;
+	size_t last = scene->totalSprites - 1;
+
+	scene->sprites[index] = scene->sprites[last];
+	scene->_spriteSlots[index] = scene->_spriteSlots[last];
+	scene->_slots[scene->_spriteSlots[index]].index = index;
+
+	scene->sprites[last] = NULL;
+	scene->totalSprites--;
+
+	// Free the slot, bumping its generation so outstanding handles go stale
+	scene->_slots[slot].generation++;
+	scene->_slots[slot].index = scene->_freeSlot;
+	scene->_freeSlot = slot;
+
+}
+
+
+PrismSprite* getSprite( Scene* scene, string spriteId ) {
+
+	if( scene->sprites == NULL ) {
+		prismaticLogger->infof( "Scene sprites NULL when getting sprite '%s'", spriteId );
+		return NULL;
+	}
+
+	void* value = prismaticHashMap->get( scene->_spriteIndex, spriteId );
+	if( value == NULL ) {
+		prismaticLogger->infof( "Sprite id '%s' not found in Scene", spriteId );
+		return NULL;
+	}
+
+	return scene->sprites[scene->_slots[valueToSlot( value )].index];
+
+}
+
+static PrismSpriteHandle getSpriteHandle( Scene* scene, string spriteId ) {
+
+	PrismSpriteHandle handle = { 0 };
+
+	void* value = prismaticHashMap->get( scene->_spriteIndex, spriteId );
+	if( value == NULL ) {
+		return handle;
+	}
+
+	handle.slot = valueToSlot( value );
+	handle.generation = scene->_slots[handle.slot].generation;
+
+	return handle;
+
+}
+
+static PrismSprite* resolveSprite( Scene* scene, PrismSpriteHandle handle ) {
+
+	if( !isValidSprite( scene, handle ) ) {
+		return NULL;
+	}
+
+	return scene->sprites[scene->_slots[handle.slot].index];
+
+}
+
+static bool isValidSprite( Scene* scene, PrismSpriteHandle handle ) {
+
+	if( scene == NULL || handle.slot >= scene->_slotCount ) {
+		return false;
+	}
+
+	// Live generations are odd, so the zero handle never matches
+	return ( handle.generation & 1 ) && scene->_slots[handle.slot].generation == handle.generation;
+
+}
+
+static bool isSceneReady( Scene* scene ) {
+	return scene->load == NULL || scene->loadState == SceneLoadState_Ready;
+}
+
+// Make room for one more Sprite and its slot. sprites keeps an extra entry 
+// for its NULL terminator, _spriteSlots shares its capacity.
+static bool reserveSprites( Scene* scene ) {
+
+	size_t count = scene->totalSprites + 2;
+	size_t spriteCapacity = scene->_spriteCapacity;
+
+	PrismSprite** spriteList = prismaticArray->reserve( scene->sprites, &spriteCapacity, count, sizeof( PrismSprite* ) );
+	if( spriteList == NULL ) {
+		return false;
+	}
+
+	scene->sprites = spriteList;
+
+	uint32_t* spriteSlots = prismaticArray->reserve( scene->_spriteSlots, &scene->_spriteCapacity, count, sizeof( uint32_t ) );
+	if( spriteSlots == NULL ) {
+		return false;
+	}
+
+	scene->_spriteSlots = spriteSlots;
+
+	if( scene->_freeSlot != SCENE_NO_SLOT ) {
+		return true;
+	}
+
+	SceneSpriteSlot* slots = prismaticArray->reserve( scene->_slots, &scene->_slotCapacity, scene->_slotCount + 1, sizeof( SceneSpriteSlot ) );
+	if( slots == NULL ) {
+		return false;
+	}
+
+	scene->_slots = slots;
+
+	return true;
+
+}
+
+// The Sprite index stores slot + 1, since the map reserves NULL for missing 
+// keys
+static void* slotToValue( uint32_t slot ) {
+	return (void*)( (uintptr_t)slot + 1 );
+}
+
+static uint32_t valueToSlot( void* value ) {
+	return (uint32_t)( (uintptr_t)value - 1 );
+}
+
+static bool sceneHasSprite( Scene* scene, PrismSprite* sp ) {
+
+	if( sp->id == NULL ) {
+		return false;
+	}
+
+	void* value = prismaticHashMap->get( scene->_spriteIndex, sp->id );
+	if( value == NULL ) {
+		return false;
+	}
+
+	return scene->sprites[scene->_slots[valueToSlot( value )].index] == sp;
+
+}
+
+// Check whether any of the bottom depth Scenes on the stack hold the Sprite
+static bool stackHasSprite( SceneManager* sceneManager, size_t depth, PrismSprite* sp ) {
+
+	for( size_t i = 0; i < depth; i++ ) {
+		if( sceneHasSprite( sceneManager->sceneStack[i], sp ) ) {
+			return true;
+		}
+	}
+
+	return false;
+
+}
+
+static void startSceneCoroutine( Scene* scene, PrismCoroutine* co, bool ( *run )( PrismCoroutine*, float ), void* data ) {
+
+	if( scene == NULL || co == NULL || run == NULL ) {
+		prismaticLogger->error( "Cannot start coroutine with NULL scene, coroutine or run function" );
+		return;
+	}
+
+	if( co->_scene != NULL && co->_scene != scene ) {
+
+		// Moving between Scenes would have to relink the coroutine while the
+		// other Scene is still walking its list
+		if( co->_scene->_resumingCoroutines ) {
+			prismaticLogger->errorf( "Cannot move a running coroutine from Scene '%s' to '%s'", co->_scene->name, scene->name );
+			return;
+		}
+
+		stopSceneCoroutine( co->_scene, co );
+
+	}
+
+	bool linked = co->_scene == scene;
+
+	prismaticCoroutine->start( co, run, data );
+	co->_scene = scene;
+
+	// A restarted coroutine keeps its place in the list
+	if( !linked ) {
+		co->_next = scene->_coroutines;
+		scene->_coroutines = co;
+	}
+
+}
+
+static void stopSceneCoroutine( Scene* scene, PrismCoroutine* co ) {
+
+	if( scene == NULL || co == NULL || co->_scene != scene ) {
+		return;
+	}
+
+	co->_done = true;
+
+	// While resuming, the coroutine is unlinked once the Scene is done
+	if( !scene->_resumingCoroutines ) {
+		unlinkCoroutines( scene );
+	}
+
+}
+
+// Resume each of the Scene's coroutines once. Coroutines started during the 
+// walk are added to the head of the list and first run on the next update.
+static void resumeCoroutines( Scene* scene, float delta ) {
+
+	if( scene->_coroutines == NULL ) {
+		return;
+	}
+
+	scene->_resumingCoroutines = true;
+
+	for( PrismCoroutine* co = scene->_coroutines; co != NULL; co = co->_next ) {
+
+		if( co->_done ) {
+			continue;
+		}
+
+		prismaticCoroutine->resume( co, delta );
+
+	}
+
+	scene->_resumingCoroutines = false;
+	unlinkCoroutines( scene );
+
+}
+
+static void stopCoroutines( Scene* scene ) {
+
+	for( PrismCoroutine* co = scene->_coroutines; co != NULL; co = co->_next ) {
+		co->_done = true;
+	}
+
+	if( !scene->_resumingCoroutines ) {
+		unlinkCoroutines( scene );
+	}
+
+}
+
+// Detach finished and stopped coroutines from the Scene
+static void unlinkCoroutines( Scene* scene ) {
+
+	PrismCoroutine** link = &scene->_coroutines;
+
+	while( *link != NULL ) {
+
+		PrismCoroutine* co = *link;
+
+		if( !co->_done ) {
+			link = &co->_next;
+			continue;
+		}
+
+		*link = co->_next;
+		co->_next = NULL;
+		co->_scene = NULL;
+
+	}
+
+}
+
+static PrismUpdateGroup* joinGroup( Scene* scene, PrismSprite* sp, void ( *update )( PrismUpdateGroup*, float ) ) {
+
+	if( scene == NULL || sp == NULL || update == NULL ) {
+		prismaticLogger->error( "Cannot join update group with NULL scene, sprite or update function" );
+		return NULL;
+	}
+
+	if( !sceneHasSprite( scene, sp ) ) {
+		prismaticLogger->errorf( "Sprite '%s' must be in Scene '%s' to join one of its update groups", sp->id, scene->name );
+		return NULL;
+	}
+
+	PrismUpdateGroup* group = getGroup( scene, update );
+	if( group == NULL ) {
+		group = newGroup( scene, update );
+		if( group == NULL ) {
+			return NULL;
+		}
+	}
+
+	if( sp->group == group ) {
+		return group;
+	}
+
+	if( !reserveGroup( group, group->count + 1 ) ) {
+		prismaticLogger->errorf( "Memory allocation failed for adding Sprite '%s' to update group", sp->id );
+		return NULL;
+	}
+
+	if( sp->group != NULL ) {
+		leaveGroup( sp->group->_scene, sp );
+	}
+
+	size_t i = group->count++;
+
+	group->sprites[i] = sp;
+	sprites->getPosition( sp->sprite, &group->x[i], &group->y[i] );
+	group->vx[i] = 0.0f;
+	group->vy[i] = 0.0f;
+
+	sp->group = group;
+	sp->groupIndex = i;
+
+	return group;
+
+}
+
+static void leaveGroup( Scene* scene, PrismSprite* sp ) {
+
+	if( sp == NULL || sp->group == NULL || sp->group->_scene != scene ) {
+		return;
+	}
+
+	PrismUpdateGroup* group = sp->group;
+	size_t i = sp->groupIndex;
+	size_t last = group->count - 1;
+
+	// Move the last member into the hole so the arrays stay dense
+	group->sprites[i] = group->sprites[last];
+	group->x[i] = group->x[last];
+	group->y[i] = group->y[last];
+	group->vx[i] = group->vx[last];
+	group->vy[i] = group->vy[last];
+	group->sprites[i]->groupIndex = i;
+
+	group->sprites[last] = NULL;
+	group->count--;
+
+	sp->group = NULL;
+	sp->groupIndex = 0;
+
+}
+
+static PrismUpdateGroup* getGroup( Scene* scene, void ( *update )( PrismUpdateGroup*, float ) ) {
+
+	if( scene == NULL ) {
+		return NULL;
+	}
+
+	for( size_t i = 0; i < scene->_groupCount; i++ ) {
+		if( scene->_groups[i]->update == update ) {
+			return scene->_groups[i];
+		}
+	}
+
+	return NULL;
+
+}
+
+static PrismUpdateGroup* newGroup( Scene* scene, void ( *update )( PrismUpdateGroup*, float ) ) {
+
+	PrismUpdateGroup** groups = prismaticArray->reserve( scene->_groups, &scene->_groupCapacity, scene->_groupCount + 1, sizeof( PrismUpdateGroup* ) );
+	if( groups == NULL ) {
+		prismaticLogger->error( "Memory allocation failed for update groups." );
+		return NULL;
+	}
+
+	scene->_groups = groups;
+
+	PrismUpdateGroup* group = calloc( 1, sizeof( PrismUpdateGroup ) );
+	if( group == NULL ) {
+		prismaticLogger->error( "Could not allocate memory for new update group" );
+		return NULL;
+	}
+
+	group->update = update;
+	group->syncPositions = true;
+	group->_scene = scene;
+
+	scene->_groups[scene->_groupCount++] = group;
+
+	return group;
+
+}
+
+// Grow every array of the group together, so they share one capacity
+static bool reserveGroup( PrismUpdateGroup* group, size_t count ) {
+
+	size_t capacity = group->_capacity;
+
+	PrismSprite** members = prismaticArray->reserve( group->sprites, &capacity, count, sizeof( PrismSprite* ) );
+	if( members == NULL ) {
+		return false;
+	}
+
+	group->sprites = members;
+
+	if( capacity == group->_capacity ) {
+		return true;
+	}
+
+	float** columns[] = { &group->x, &group->y, &group->vx, &group->vy };
+
+	for( size_t i = 0; i < sizeof( columns ) / sizeof( columns[0] ); i++ ) {
+
+		float* column = sys->realloc( *columns[i], sizeof( float ) * capacity );
+		if( column == NULL ) {
+			return false;
+		}
+
+		*columns[i] = column;
+
+	}
+
+	group->_capacity = capacity;
+
+	return true;
+
+}
+
+static void updateGroups( Scene* scene, float delta ) {
+
+	for( size_t i = 0; i < scene->_groupCount; i++ ) {
+
+		PrismUpdateGroup* group = scene->_groups[i];
+		if( group->count == 0 ) {
+			continue;
+		}
+
+		group->update( group, delta );
+
+		if( !group->syncPositions ) {
+			continue;
+		}
+
+		// Dormant members keep their place until they wake
+		for( size_t j = 0; j < group->count; j++ ) {
+			if( !group->sprites[j]->dormant ) {
+				sprites->moveTo( group->sprites[j]->sprite, group->x[j], group->y[j] );
+			}
+		}
+
+	}
+
+}
+
+static void deleteGroups( Scene* scene ) {
+
+	for( size_t i = 0; i < scene->_groupCount; i++ ) {
+
+		PrismUpdateGroup* group = scene->_groups[i];
+
+		// Members may outlive the Scene if they are shared with another one
+		for( size_t j = 0; j < group->count; j++ ) {
+			group->sprites[j]->group = NULL;
+			group->sprites[j]->groupIndex = 0;
+		}
+
+		size_t capacity = group->_capacity;
+		group->sprites = prismaticArray->release( group->sprites, &capacity );
+		group->x = sys->realloc( group->x, 0 );
+		group->y = sys->realloc( group->y, 0 );
+		group->vx = sys->realloc( group->vx, 0 );
+		group->vy = sys->realloc( group->vy, 0 );
+
+		free( group );
+
+	}
+
+	scene->_groups = prismaticArray->release( scene->_groups, &scene->_groupCapacity );
+	scene->_groupCount = 0;
+
+}
+
+static void setActivation( Scene* scene, PrismSprite* sp, PrismActivation activation ) {
+
+	if( scene == NULL || sp == NULL ) {
+		prismaticLogger->error( "Cannot set activation with NULL scene or sprite" );
+		return;
+	}
+
+	// The Sprite may be filed in another Scene's grid
+	if( sp->_gridScene != NULL && activation != PrismActivation_NearCamera ) {
+		gridRemove( sp->_gridScene, sp );
+	}
+
+	sp->activation = activation;
+	sp->dormant = activation == PrismActivation_Never;
+
+	if( activation != PrismActivation_NearCamera || sp->_gridScene != NULL ) {
+		return;
+	}
+
+	// Asleep until the next update checks it against the camera
+	if( sceneHasSprite( scene, sp ) && !gridInsert( scene, sp ) ) {
+		prismaticLogger->errorf( "Could not add Sprite '%s' to activation grid, it will always update", sp->id );
+		sp->activation = PrismActivation_Always;
+	}
+
+}
+
+static void moveSprite( Scene* scene, PrismSprite* sp, float x, float y ) {
+
+	if( scene == NULL || sp == NULL ) {
+		prismaticLogger->error( "Cannot move Sprite with NULL scene or sprite" );
+		return;
+	}
+
+	sprites->moveTo( sp->sprite, x, y );
+
+	if( sp->group != NULL && sp->group->_scene == scene ) {
+		sp->group->x[sp->groupIndex] = x;
+		sp->group->y[sp->groupIndex] = y;
+	}
+
+	// The Sprite may be filed in another Scene's grid
+	if( sp->_gridScene != NULL ) {
+		gridMove( sp->_gridScene, sp );
+	}
+
+}
+
+static void setCamera( Scene* scene, float x, float y, float width, float height ) {
+
+	if( scene == NULL ) {
+		return;
+	}
+
+	scene->camera = (PDRect){ x, y, width, height };
+
+}
+
+static bool gridInsert( Scene* scene, PrismSprite* sp ) {
+
+	if( scene->_activationGrid == NULL ) {
+		scene->_activationGrid = calloc( SCENE_ACTIVATION_BUCKETS, sizeof( SceneActivationBucket ) );
+		if( scene->_activationGrid == NULL ) {
+			prismaticLogger->error( "Could not allocate memory for activation grid" );
+			return false;
+		}
+	}
+
+	float x = 0, y = 0;
+	sprites->getPosition( sp->sprite, &x, &y );
+
+	int32_t cellX = activationCell( x );
+	int32_t cellY = activationCell( y );
+	SceneActivationBucket* bucket = activationBucket( scene, cellX, cellY );
+
+	PrismSprite** grown = prismaticArray->reserve( bucket->sprites, &bucket->capacity, bucket->count + 1, sizeof( PrismSprite* ) );
+	if( grown == NULL ) {
+		prismaticLogger->error( "Memory allocation failed for activation grid." );
+		return false;
+	}
+
+	bucket->sprites = grown;
+	bucket->sprites[bucket->count] = sp;
+
+	sp->_cellX = cellX;
+	sp->_cellY = cellY;
+	sp->_cellSlot = bucket->count++;
+	sp->_gridScene = scene;
+	sp->dormant = true;
+
+	return true;
+
+}
+
+static void gridRemove( Scene* scene, PrismSprite* sp ) {
+
+	if( sp->_gridScene != scene || scene->_activationGrid == NULL ) {
+		return;
+	}
+
+	SceneActivationBucket* bucket = activationBucket( scene, sp->_cellX, sp->_cellY );
+	if( sp->_cellSlot >= bucket->count || bucket->sprites[sp->_cellSlot] != sp ) {
+		return;
+	}
+
+	size_t last = bucket->count - 1;
+
+	// Move the last Sprite in the bucket into the hole
+	bucket->sprites[sp->_cellSlot] = bucket->sprites[last];
+	bucket->sprites[sp->_cellSlot]->_cellSlot = sp->_cellSlot;
+	bucket->sprites[last] = NULL;
+	bucket->count--;
+
+	sp->_gridScene = NULL;
+	removeAwake( scene, sp );
+
+}
+
+static void removeAwake( Scene* scene, PrismSprite* sp ) {
+
+	for( size_t i = 0; i < scene->_awakeCount; i++ ) {
+		if( scene->_awake[i] == sp ) {
+			scene->_awake[i] = scene->_awake[--scene->_awakeCount];
+			return;
+		}
+	}
+
+}
+
+// Wake the NearCamera Sprites in grid cells near the camera and put the rest
+// to sleep. Only the Sprites awake last frame were updated, so only they are
+// re-filed into their current cell first. Dormant Sprites are re-filed by 
+// moveSprite as they move, and their update groups leave them in place.
+static void updateActivation( Scene* scene ) {
+
+	if( scene->_activationGrid == NULL ) {
+		return;
+	}
+
+	for( size_t i = 0; i < scene->_awakeCount; i++ ) {
+		gridMove( scene, scene->_awake[i] );
+	}
+
+	float margin = scene->activationMargin;
+	int32_t minX = activationCell( scene->camera.x - margin );
+	int32_t minY = activationCell( scene->camera.y - margin );
+	int32_t maxX = activationCell( scene->camera.x + scene->camera.width + margin );
+	int32_t maxY = activationCell( scene->camera.y + scene->camera.height + margin );
+
+	uint32_t frame = ++scene->_activationFrame;
+	size_t awakeCount = 0;
+
+	for( int32_t cellY = minY; cellY <= maxY; cellY++ ) {
+		for( int32_t cellX = minX; cellX <= maxX; cellX++ ) {
+
+			SceneActivationBucket* bucket = activationBucket( scene, cellX, cellY );
+
+			for( size_t i = 0; i < bucket->count; i++ ) {
+
+				PrismSprite* sp = bucket->sprites[i];
+
+				// Buckets are shared by cells that hash alike
+				if( sp->_cellX != cellX || sp->_cellY != cellY ) {
+					continue;
+				}
+
+				PrismSprite** grown = prismaticArray->reserve( scene->_nextAwake, &scene->_nextAwakeCapacity, awakeCount + 1, sizeof( PrismSprite* ) );
+				if( grown == NULL ) {
+					prismaticLogger->error( "Memory allocation failed for awake sprites." );
+					break;
+				}
+
+				scene->_nextAwake = grown;
+				scene->_nextAwake[awakeCount++] = sp;
+
+				sp->_awakeFrame = frame;
+				sp->dormant = false;
+
+			}
+
+		}
+	}
+
+	for( size_t i = 0; i < scene->_awakeCount; i++ ) {
+		if( scene->_awake[i]->_awakeFrame != frame ) {
+			scene->_awake[i]->dormant = true;
+		}
+	}
+
+	PrismSprite** awake = scene->_awake;
+	size_t awakeCapacity = scene->_awakeCapacity;
+
+	scene->_awake = scene->_nextAwake;
+	scene->_awakeCapacity = scene->_nextAwakeCapacity;
+	scene->_awakeCount = awakeCount;
+
+	scene->_nextAwake = awake;
+	scene->_nextAwakeCapacity = awakeCapacity;
+
+}
+
+// Move a Sprite to the grid cell under its position
+static void gridMove( Scene* scene, PrismSprite* sp ) {
+
+	float x = 0, y = 0;
+	sprites->getPosition( sp->sprite, &x, &y );
+
+	int32_t cellX = activationCell( x );
+	int32_t cellY = activationCell( y );
+	if( cellX == sp->_cellX && cellY == sp->_cellY ) {
+		return;
+	}
+
+	SceneActivationBucket* from = activationBucket( scene, sp->_cellX, sp->_cellY );
+	SceneActivationBucket* to = activationBucket( scene, cellX, cellY );
+
+	if( from != to ) {
+
+		PrismSprite** grown = prismaticArray->reserve( to->sprites, &to->capacity, to->count + 1, sizeof( PrismSprite* ) );
+		if( grown == NULL ) {
+			prismaticLogger->error( "Memory allocation failed for activation grid." );
+			return;
+		}
+
+		to->sprites = grown;
+
+		size_t last = from->count - 1;
+		from->sprites[sp->_cellSlot] = from->sprites[last];
+		from->sprites[sp->_cellSlot]->_cellSlot = sp->_cellSlot;
+		from->sprites[last] = NULL;
+		from->count--;
+
+		to->sprites[to->count] = sp;
+		sp->_cellSlot = to->count++;
+
+	}
+
+	sp->_cellX = cellX;
+	sp->_cellY = cellY;
+
+}
+
+static void deleteActivationGrid( Scene* scene ) {
+
+	if( scene->_activationGrid != NULL ) {
+
+		for( size_t i = 0; i < SCENE_ACTIVATION_BUCKETS; i++ ) {
+
+			SceneActivationBucket* bucket = &scene->_activationGrid[i];
+
+			for( size_t j = 0; j < bucket->count; j++ ) {
+				bucket->sprites[j]->_gridScene = NULL;
+				bucket->sprites[j]->dormant = false;
+			}
+
+			bucket->sprites = prismaticArray->release( bucket->sprites, &bucket->capacity );
+
+		}
+
+		free( scene->_activationGrid );
+		scene->_activationGrid = NULL;
+
+	}
+
+	scene->_awake = prismaticArray->release( scene->_awake, &scene->_awakeCapacity );
+	scene->_nextAwake = prismaticArray->release( scene->_nextAwake, &scene->_nextAwakeCapacity );
+	scene->_awakeCount = 0;
+
+}
+
+static int32_t activationCell( float position ) {
+
+	int32_t cell = (int32_t)( position / SCENE_ACTIVATION_CELL );
+
+	// Round towards negative infinity, so -1 and 1 land in different cells
+	if( position < 0 && (float)cell * SCENE_ACTIVATION_CELL != position ) {
+		cell--;
+	}
+
+	return cell;
+
+}
+
+static SceneActivationBucket* activationBucket( Scene* scene, int32_t cellX, int32_t cellY ) {
+
+	uint32_t hash = (uint32_t)cellX * 73856093u ^ (uint32_t)cellY * 19349663u;
+	return &scene->_activationGrid[hash & ( SCENE_ACTIVATION_BUCKETS - 1 )];
 
 }
 
@@ -466,4 +1864,16 @@ const SceneFn* prismaticScene = &(SceneFn) {
 	.add = addSprite,
 	.remove = removeSprite,
 	.get = getSprite,
-};
\ No newline at end of file
+	.getHandle = getSpriteHandle,
+	.resolve = resolveSprite,
+	.isValid = isValidSprite,
+	.isReady = isSceneReady,
+	.startCoroutine = startSceneCoroutine,
+	.stopCoroutine = stopSceneCoroutine,
+	.joinGroup = joinGroup,
+	.leaveGroup = leaveGroup,
+	.getGroup = getGroup,
+	.setActivation = setActivation,
+	.setCamera = setCamera,
+	.moveSprite = moveSprite,
+};
@@ -17,13 +17,138 @@
 	#include "../sprite/sprite.h"
 #endif
 
+#ifndef HASHMAP_INCLUDED
+	#define HASHMAP_INCLUDED
+	#include "../collections/hashmap.h"
+#endif
+
+#ifndef STDINT_INCLUDED
+	#define STDINT_INCLUDED
+	#include <stdint.h>
+#endif
+
+#ifndef COROUTINE_INCLUDED
+	#define COROUTINE_INCLUDED
+	#include "../coroutine/coroutine.h"
+#endif
+
+// A stable reference to a Sprite in a Scene. 
+// 
+// A handle goes stale once its Sprite is removed from the Scene, which can 
+// be checked with prismaticScene->isValid() without touching the Sprite. The 
+// zero handle is never valid.
+typedef struct PrismSpriteHandle {
+	uint32_t slot;
+	uint32_t generation;
+} PrismSpriteHandle;
+
+typedef struct SceneSpriteSlot {
+	// Odd while the slot holds a Sprite, even while it is free
+	uint32_t generation;
+	// Index into scene->sprites when live, next free slot when free
+	uint32_t index;
+} SceneSpriteSlot;
+
+// Sprites in a Scene that share one update function, stored as parallel 
+// arrays so the whole batch is updated with a single call. Index i of each 
+// array belongs to sprites[i].
+typedef struct PrismUpdateGroup {
+	PrismSprite** sprites;
+	float* x;
+	float* y;
+	float* vx;
+	float* vy;
+	size_t count;
+	size_t _capacity;
+	// Move each member's LCDSprite to its x & y after every update. On by 
+	// default, turn off for groups that move their Sprites themselves.
+	bool syncPositions;
+	// Optional - Data shared by the group. Caller is responsible for freeing it.
+	void* ref;
+	struct Scene* _scene;
+	// Updates every member of the group. Walk the arrays backwards to remove
+	// members during the update. Members whose sprite is dormant should be 
+	// skipped, see prismaticScene->setActivation.
+	//
+	// ----
+	//
+	// PrismUpdateGroup* self
+	//
+	// float delta
+	void ( *update )( struct PrismUpdateGroup*, float );
+} PrismUpdateGroup;
+
+// Sprites with PrismActivation_NearCamera whose position hashes to the same
+// activation grid cell
+typedef struct SceneActivationBucket {
+	PrismSprite** sprites;
+	size_t count;
+	size_t capacity;
+} SceneActivationBucket;
+
+// The loading progress of a Scene with a load function
+typedef enum {
+	SceneLoadState_Unloaded,
+	SceneLoadState_Loading,
+	SceneLoadState_Ready,
+	// Set by the load function when loading can never finish
+	SceneLoadState_Failed,
+} SceneLoadState;
+
 typedef struct Scene {
 	string name;
+	// Dense, NULL terminated array of the Scene's Sprites, in update order.
+	// Order is not preserved when Sprites are removed.
 	PrismSprite** sprites;
 	size_t totalSprites;
+	// Slot map backing sprites
+	size_t _spriteCapacity;
+	uint32_t* _spriteSlots;
+	SceneSpriteSlot* _slots;
+	size_t _slotCount;
+	size_t _slotCapacity;
+	uint32_t _freeSlot;
+	// Sprite id -> slot
+	PrismHashMap* _spriteIndex;
+	// Handles of the Sprites being updated, taken before the first update
+	// so removals during the pass neither skip nor repeat a Sprite
+	PrismSpriteHandle* _updateOrder;
+	size_t _updateCapacity;
 	bool isActive;
+	// Set when the Scene is pushed as an overlay that freezes the Scenes 
+	// below it
+	bool _freezesBelow;
 	struct SceneManager* sceneManager;
 	void* ref;
+	// Release the Scene once it exits, see registerScene
+	bool disposable;
+	// The visible area, in world coordinates. Sprites with 
+	// PrismActivation_NearCamera only update while within 
+	// activationMargin of it. See setCamera.
+	PDRect camera;
+	float activationMargin;
+	// Coarse grid of NearCamera Sprites, allocated on first use
+	SceneActivationBucket* _activationGrid;
+	// NearCamera Sprites updated this frame, and scratch space for the next
+	PrismSprite** _awake;
+	size_t _awakeCount;
+	size_t _awakeCapacity;
+	PrismSprite** _nextAwake;
+	size_t _nextAwakeCapacity;
+	uint32_t _activationFrame;
+	// Update groups, keyed by their update function
+	PrismUpdateGroup** _groups;
+	size_t _groupCount;
+	size_t _groupCapacity;
+	// Coroutines resumed with the Scene's update, newest first
+	PrismCoroutine* _coroutines;
+	bool _resumingCoroutines;
+	// Only used when the Scene has a load function
+	SceneLoadState loadState;
+	// Optional - Loads one step of the Scene's assets, returns true once 
+	// loading is finished. Called by the SceneManager after a preload. Set
+	// loadState to SceneLoadState_Failed and return false to stop loading.
+	bool ( *load )( struct Scene* );
 	void ( *enter )( struct Scene* );
 	void ( *update )( struct Scene*, float );
 	void ( *draw )( struct Scene*, float );
@@ -31,12 +156,46 @@ typedef struct Scene {
 	void ( *destroy )( struct Scene* );
 } Scene;
 
+// Builds a Scene on demand, see prismaticSceneManager->registerScene
+typedef struct SceneFactory {
+	string name;
+	Scene* ( *build )( void );
+	bool disposable;
+} SceneFactory;
+
 typedef struct SceneManager {
 	Scene** scenes;
 	int totalScenes;
+	size_t _sceneCapacity;
 	Scene* defaultScene;
 	Scene* currentScene;
 	Scene* previousScene;
+	// Scenes on screen, from the base Scene up to the top overlay. The top 
+	// of the stack is always currentScene.
+	Scene** sceneStack;
+	size_t stackSize;
+	size_t _stackCapacity;
+	// Scene name -> Scene*, maintained by add / remove
+	PrismHashMap* _sceneIndex;
+	// Sprites that stay on screen across Scene changes
+	PrismSprite** persistentSprites;
+	size_t totalPersistentSprites;
+	size_t _persistentCapacity;
+	// Scenes waiting to finish loading, in the order they were preloaded
+	Scene** _preloadQueue;
+	size_t _preloadCount;
+	size_t _preloadCapacity;
+	// Milliseconds per update spent running Scene load steps
+	unsigned int preloadBudget;
+	// Registered Scene factories, indexed by Scene name
+	SceneFactory** _factories;
+	size_t _factoryCount;
+	size_t _factoryCapacity;
+	PrismHashMap* _factoryIndex;
+	// Disposable Scenes that have exited, released at the next update
+	Scene** _disposeQueue;
+	size_t _disposeCount;
+	size_t _disposeCapacity;
 	void (*destroy)( struct SceneManager* );
 } SceneManager; 
 
@@ -50,6 +209,10 @@ typedef struct SceneFn {
 
 	// Deletes the Scene
 	// 
+	// Sprites that are shared with another Scene, owned by a SceneManager
+	// as persistent Sprites, or owned by a prismaticSpritePool, are not 
+	// deleted.
+	// 
 	// ----
 	// 
 	// Scene* scene
@@ -57,6 +220,13 @@ typedef struct SceneFn {
 
 	// Add the Sprite to the Scene. 
 	// 
+	// Returns a handle to the Sprite, or the zero handle if the Sprite could 
+	// not be added. Sprites whose id is already in the Scene are rejected.
+	// 
+	// The same Sprite may be added to several Scenes, as long as it uses the
+	// same id in each. Shared Sprites stay on screen when changing between
+	// those Scenes and are deleted along with the last Scene holding them.
+	// 
 	// ----
 	// 
 	// Scene* scene
@@ -64,10 +234,12 @@ typedef struct SceneFn {
 	// string spriteId - A unique identifier for sprite
 	// 
 	// PrismSprite* sprite
-	void ( *add )( struct Scene*, string, PrismSprite* );
+	PrismSpriteHandle ( *add )( struct Scene*, string, PrismSprite* );
 
 	// Remove the Sprite from the Scene
 	// 
+	// Any handles to the Sprite go stale.
+	// 
 	// ----
 	// 
 	// Scene* scene 
@@ -83,6 +255,165 @@ typedef struct SceneFn {
 	// 
 	// string spriteId
 	PrismSprite* ( *get )( struct Scene*, string );
+
+	// Get the handle for a Sprite in the Scene by its string ID
+	// 
+	// Returns the zero handle if the id is not in the Scene.
+	// 
+	// ----
+	// 
+	// Scene* scene
+	// 
+	// string spriteId
+	PrismSpriteHandle ( *getHandle )( struct Scene*, string );
+
+	// Get the Sprite a handle refers to, or NULL if the handle is stale
+	// 
+	// ----
+	// 
+	// Scene* scene
+	// 
+	// PrismSpriteHandle handle
+	PrismSprite* ( *resolve )( struct Scene*, PrismSpriteHandle );
+
+	// Check whether a handle still refers to a Sprite in the Scene
+	// 
+	// ----
+	// 
+	// Scene* scene
+	// 
+	// PrismSpriteHandle handle
+	bool ( *isValid )( struct Scene*, PrismSpriteHandle );
+
+	// Check whether the Scene can be changed to. A Scene without a load 
+	// function is always ready, one whose loading failed never is.
+	// 
+	// ----
+	// 
+	// Scene* scene
+	bool ( *isReady )( struct Scene* );
+
+	// Start a coroutine on the Scene
+	// 
+	// The SceneManager resumes the coroutine after each scene->update() 
+	// until it finishes, the Scene exits, or it is stopped. The coroutine is 
+	// owned by the caller and must stay alive until then. Starting a 
+	// coroutine that is already running restarts it.
+	// 
+	// ----
+	// 
+	// Scene* scene
+	// 
+	// PrismCoroutine* co
+	// 
+	// bool ( *run )( PrismCoroutine*, float ) - The coroutine body
+	// 
+	// void* data
+	void ( *startCoroutine )( struct Scene*, PrismCoroutine*, bool (*)( PrismCoroutine*, float ), void* );
+
+	// Stop a coroutine running on the Scene
+	// 
+	// ----
+	// 
+	// Scene* scene
+	// 
+	// PrismCoroutine* co
+	void ( *stopCoroutine )( struct Scene*, PrismCoroutine* );
+
+	// Add a Sprite in the Scene to the update group for an update function,
+	// creating the group if needed
+	// 
+	// Grouped Sprites are updated by the group instead of by sprite->update().
+	// The Sprite's current position is copied into the group, its velocity 
+	// starts at 0. A Sprite already in a group is moved to the new one.
+	// 
+	// Returns the group, or NULL if the Sprite could not be added.
+	// 
+	// ----
+	// 
+	// Scene* scene
+	// 
+	// PrismSprite* sprite
+	// 
+	// void ( *update )( PrismUpdateGroup*, float ) - The group's update function
+	PrismUpdateGroup* ( *joinGroup )( struct Scene*, PrismSprite*, void (*)( PrismUpdateGroup*, float ) );
+
+	// Remove a Sprite from its update group
+	// 
+	// The last member of the group takes the Sprite's place, so its 
+	// groupIndex changes. Removing a Sprite from the Scene also removes it 
+	// from its group.
+	// 
+	// ----
+	// 
+	// Scene* scene
+	// 
+	// PrismSprite* sprite
+	void ( *leaveGroup )( struct Scene*, PrismSprite* );
+
+	// Get the Scene's update group for an update function, or NULL if no 
+	// Sprite has joined it
+	// 
+	// ----
+	// 
+	// Scene* scene
+	// 
+	// void ( *update )( PrismUpdateGroup*, float )
+	PrismUpdateGroup* ( *getGroup )( struct Scene*, void (*)( PrismUpdateGroup*, float ) );
+
+	// Set whether a Sprite in the Scene is always updated, never updated, or
+	// only updated near the camera
+	// 
+	// Sprites with PrismActivation_NearCamera are kept in a coarse grid and
+	// only updated while their cell is within scene->activationMargin of the
+	// camera. Awake Sprites are re-filed each update however they moved, 
+	// dormant ones must be moved with moveSprite for the grid to follow them.
+	// Dormant Sprites skip sprite->update(), so any animation played from it 
+	// stops too. Update groups should skip dormant members themselves, their
+	// positions are not synced until they wake. A NearCamera Sprite shared by several Scenes is
+	// only kept in the grid of the first Scene it was added to.
+	// 
+	// ----
+	// 
+	// Scene* scene
+	// 
+	// PrismSprite* sprite
+	// 
+	// PrismActivation activation
+	void ( *setActivation )( struct Scene*, PrismSprite*, PrismActivation );
+
+	// Move the Scene's camera, used to wake Sprites with 
+	// PrismActivation_NearCamera. Defaults to the screen at 0, 0.
+	// 
+	// ----
+	// 
+	// Scene* scene
+	// 
+	// float x
+	// 
+	// float y
+	// 
+	// float width
+	// 
+	// float height
+	void ( *setCamera )( struct Scene*, float, float, float, float );
+
+	// Move a Sprite in the Scene, keeping its update group position and its
+	// activation grid cell in step
+	// 
+	// Use this instead of sprites->moveTo for Sprites that may be dormant, 
+	// the grid only re-files awake Sprites by itself.
+	// 
+	// ----
+	// 
+	// Scene* scene
+	// 
+	// PrismSprite* sprite
+	// 
+	// float x
+	// 
+	// float y
+	void ( *moveSprite )( struct Scene*, PrismSprite*, float, float );
 } SceneFn;
 
 typedef struct SceneManagerFn {
@@ -106,8 +437,16 @@ typedef struct SceneManagerFn {
 
 	// Updates the SceneManager. 
 	// 
-	// First, calls scene->update() for the SceneManager's current Scene. 
-	// Then, calls sprite->update() for each Sprite in the Scene.
+	// First, releases any disposable Scenes that exited since the last 
+	// update. Then, runs load steps for any preloading Scenes within the preload 
+	// budget. Then, for each Scene on the stack that is not frozen by an overlay, from the 
+	// bottom up, calls scene->update(), wakes or puts to sleep Sprites near 
+	// the camera, then each update group's update, then sprite->update() for
+	// each ungrouped, awake Sprite in the Scene, in order (Sprites removed by 
+	// an earlier one are skipped, those added wait for the next update), then
+	// resumes the Scene's coroutines. Then, calls sprite->update() for 
+	// each persistent Sprite. Finally, advances the Animations of the Sprites
+	// updated with prismaticAnimation->tickAll.
 	// 
 	// ----
 	// 
@@ -117,7 +456,8 @@ typedef struct SceneManagerFn {
 
 	// Draws the SceneManager. 
 	// 
-	// Calls scene->draw() for the SceneManager's current Scene.
+	// Calls scene->draw() for each Scene on the stack, from the base Scene up
+	// to the top overlay.
 	// 
 	// ----
 	// 
@@ -136,6 +476,15 @@ typedef struct SceneManagerFn {
 
 	// Change the current Scene to the given Scene.
 	// 
+	// The Scene must be ready, see prismaticScene->isReady(). Any overlay Scenes are popped first, then the base Scene is replaced.
+	// Only the Sprites that differ between the two Scenes are removed from
+	// or added to the screen. Sprites shared by both Scenes and persistent 
+	// Sprites stay where they are. The screen is not cleared with 
+	// sprites->removeAllSprites, so LCDSprites added outside of a Scene, such
+	// as a tile map's or an acquired pool Sprite's that was never added to 
+	// the Scene, stay on screen until removed. Remove them in scene->exit, as 
+	// the PlayScene does with its map.
+	// 
 	// ----
 	// 
 	// SceneManager* sceneManager
@@ -157,6 +506,9 @@ typedef struct SceneManagerFn {
 
 	// Add a Scene to the SceneManager
 	// 
+	// Scene names must be unique within a SceneManager, they are indexed so
+	// that lookups and changes by name do not walk the Scene list.
+	// 
 	// ----
 	// 
 	// SceneManager* sceneManager
@@ -181,7 +533,8 @@ typedef struct SceneManagerFn {
 	// 
 	// Does not destroy the Scene upon removal. If a Scene is removed from a 
 	// SceneManager before the SceneManager is destroyed, the caller is 
-	// responsible for destroying the Scene.
+	// responsible for destroying the Scene. Does nothing if no Scene by that
+	// name has been added or built yet.
 	// 
 	// ----
 	// 
@@ -192,12 +545,112 @@ typedef struct SceneManagerFn {
 
 	// Get a Scene by its name from the SceneManager
 	// 
+	// If the Scene has not been built yet but a factory is registered under
+	// the name, the Scene is built and added to the SceneManager first.
+	// 
 	// ----
 	// 
 	// SceneManager* sceneManager
 	// 
 	// string sceneName - The Scene's name
 	Scene* ( *get )( SceneManager*, string );
+
+	// Add a persistent Sprite to the SceneManager
+	// 
+	// Persistent Sprites, such as a HUD or the player, stay on screen and 
+	// keep updating across Scene changes. The SceneManager takes ownership 
+	// and deletes them when it is deleted.
+	// 
+	// ----
+	// 
+	// SceneManager* sceneManager
+	// 
+	// PrismSprite* sprite
+	void ( *addPersistent )( SceneManager*, PrismSprite* );
+
+	// Remove a persistent Sprite from the SceneManager and the screen
+	// 
+	// Does not delete the Sprite, the caller becomes responsible for it.
+	// 
+	// ----
+	// 
+	// SceneManager* sceneManager
+	// 
+	// PrismSprite* sprite
+	void ( *removePersistent )( SceneManager*, PrismSprite* );
+
+	// Push an overlay Scene, such as a pause menu, on top of the current Scene
+	// 
+	// The Scenes below stay resident: their Sprites stay on screen, they keep
+	// drawing, and their exit functions are not called. The overlay is added 
+	// to the SceneManager if it is not already. Returns NULL if it cannot be 
+	// pushed, such as when a different Scene already has its name.
+	// 
+	// ----
+	// 
+	// SceneManager* sceneManager
+	// 
+	// Scene* overlay
+	// 
+	// bool freezeBelow - Stop updating the Scenes below while the overlay is 
+	// on the stack
+	Scene* ( *push )( SceneManager*, Scene*, bool );
+
+	// Pop the top overlay Scene, returning to the Scene below it
+	// 
+	// Calls the overlay's exit function and removes only the Sprites that the
+	// Scenes below do not share. The Scene below is not re-entered. Returns 
+	// the new current Scene, or NULL if there is no overlay to pop.
+	// 
+	// ----
+	// 
+	// SceneManager* sceneManager
+	Scene* ( *pop )( SceneManager* );
+
+	// Start loading a Scene in the background
+	// 
+	// The Scene's load function is called from update until it returns true,
+	// spending at most the preload budget each frame (a step that is 
+	// already running is always finished), or until it sets the Scene's 
+	// loadState to SceneLoadState_Failed. The Scene is added to the 
+	// SceneManager if it is not already. Does nothing if the Scene is ready,
+	// preloading a Scene that failed starts loading it again.
+	// 
+	// ----
+	// 
+	// SceneManager* sceneManager
+	// 
+	// Scene* scene
+	void ( *preload )( SceneManager*, Scene* );
+
+	// Set how many milliseconds of each update may be spent loading Scenes.
+	// Defaults to 4. At least one load step runs per update regardless.
+	// 
+	// ----
+	// 
+	// SceneManager* sceneManager
+	// 
+	// unsigned int budget - The budget in milliseconds
+	void ( *setPreloadBudget )( SceneManager*, unsigned int );
+
+	// Register a function that builds the named Scene
+	// 
+	// The Scene is only built the first time it is needed, by get, 
+	// changeSceneByName or preload via get. Disposable Scenes are deleted 
+	// at the start of the update after they exit, and built again if they 
+	// are needed later. A disposable Scene's destroy function should reset 
+	// any state kept outside of the Scene so it can be rebuilt.
+	// 
+	// ----
+	// 
+	// SceneManager* sceneManager
+	// 
+	// string sceneName - Must match the name of the Scene that build returns
+	// 
+	// Scene* ( *build )( void ) - Creates the Scene
+	// 
+	// bool disposable - Release the Scene once it exits
+	void ( *registerScene )( SceneManager*, string, Scene* (*)( void ), bool );
 } SceneManagerFn;
 
 // The Prismatic Engine Scene Global
@@ -0,0 +1,304 @@
+#include <stddef.h>
+#include <stdlib.h>
+
+#include "../prismatic.h"
+#include "scheduler.h"
+
+static PrismJob* addJob( string name, int priority, bool ( *step )( PrismJob* ), void* data );
+static bool cancelJob( PrismJobId id );
+static PrismJob* getJob( PrismJobId id );
+static void tickScheduler( float budget );
+static size_t countJobs( void );
+static void logJobStats( void );
+static void clearJobs( void );
+
+static void insertJob( PrismJob* job );
+static void sweepJobs( void );
+static PrismJob* findJob( PrismJobId id );
+
+// Scheduled jobs, sorted by priority, highest first
+static PrismJob** jobs = NULL;
+static size_t jobCount = 0;
+static size_t jobCapacity = 0;
+
+// Jobs added while the scheduler is running, merged in once it is done
+static PrismJob** pending = NULL;
+static size_t pendingCount = 0;
+static size_t pendingCapacity = 0;
+
+static bool ticking = false;
+static PrismJobId nextId = 1;
+
+static PrismJob* addJob( string name, int priority, bool ( *step )( PrismJob* ), void* data ) {
+
+	if( step == NULL ) {
+		prismaticLogger->errorf( "Cannot schedule job '%s' without a step function", name );
+		return NULL;
+	}
+
+	PrismJob* job = calloc( 1, sizeof( PrismJob ) );
+	if( job == NULL ) {
+		prismaticLogger->error( "Could not allocate memory for new job" );
+		return NULL;
+	}
+
+	job->id = nextId++;
+	if( nextId == 0 ) {
+		nextId = 1;
+	}
+
+	job->name = name;
+	job->priority = priority;
+	job->step = step;
+	job->data = data;
+
+	if( !ticking ) {
+		insertJob( job );
+		return job;
+	}
+
+	PrismJob** grown = prismaticArray->reserve( pending, &pendingCapacity, pendingCount + 1, sizeof( PrismJob* ) );
+	if( grown == NULL ) {
+		prismaticLogger->errorf( "Memory allocation failed for scheduling job '%s'", name );
+		free( job );
+		return NULL;
+	}
+
+	pending = grown;
+	pending[pendingCount++] = job;
+
+	return job;
+
+}
+
+static bool cancelJob( PrismJobId id ) {
+
+	PrismJob* job = findJob( id );
+	if( job == NULL ) {
+		return false;
+	}
+
+	job->_cancelled = true;
+
+	// While running, the job is cleaned up at the end of the tick
+	if( !ticking ) {
+		sweepJobs();
+	}
+
+	return true;
+
+}
+
+static PrismJob* getJob( PrismJobId id ) {
+	return findJob( id );
+}
+
+static void tickScheduler( float budget ) {
+
+	if( jobCount == 0 || budget <= 0.0f ) {
+		return;
+	}
+
+	float start = sys->getElapsedTime();
+	bool ran = true;
+
+	ticking = true;
+
+	// Give each job a step per pass, highest priority first, until the budget
+	// is spent or every job is done
+	while( ran ) {
+
+		ran = false;
+
+		for( size_t i = 0; i < jobCount; i++ ) {
+
+			PrismJob* job = jobs[i];
+			if( job->_cancelled || job->_finished ) {
+				continue;
+			}
+
+			float before = sys->getElapsedTime();
+			if( before - start >= budget ) {
+				ran = false;
+				break;
+			}
+
+			job->_finished = job->step( job );
+
+			float stepTime = sys->getElapsedTime() - before;
+			job->steps++;
+			job->totalTime += stepTime;
+			if( stepTime > job->maxStepTime ) {
+				job->maxStepTime = stepTime;
+			}
+
+			ran = true;
+
+		}
+
+	}
+
+	ticking = false;
+	sweepJobs();
+
+}
+
+static size_t countJobs( void ) {
+
+	size_t count = 0;
+
+	for( size_t i = 0; i < jobCount; i++ ) {
+		if( !jobs[i]->_cancelled && !jobs[i]->_finished ) {
+			count++;
+		}
+	}
+
+	for( size_t i = 0; i < pendingCount; i++ ) {
+		if( !pending[i]->_cancelled ) {
+			count++;
+		}
+	}
+
+	return count;
+
+}
+
+static void logJobStats( void ) {
+
+	for( size_t i = 0; i < jobCount; i++ ) {
+
+		PrismJob* job = jobs[i];
+
+		prismaticLogger->infof(
+			"Job '%s' (id %u, priority %d): %u steps, %.2fms total, %.2fms longest step",
+			job->name,
+			job->id,
+			job->priority,
+			job->steps,
+			job->totalTime * 1000.0f,
+			job->maxStepTime * 1000.0f
+		);
+
+	}
+
+}
+
+static void clearJobs( void ) {
+
+	for( size_t i = 0; i < jobCount; i++ ) {
+		jobs[i]->_cancelled = true;
+	}
+
+	for( size_t i = 0; i < pendingCount; i++ ) {
+		pending[i]->_cancelled = true;
+	}
+
+	if( ticking ) {
+		return;
+	}
+
+	sweepJobs();
+
+	// Jobs scheduled by a complete function while clearing are dropped too
+	while( jobCount > 0 ) {
+
+		for( size_t i = 0; i < jobCount; i++ ) {
+			jobs[i]->_cancelled = true;
+		}
+
+		sweepJobs();
+
+	}
+
+	jobs = prismaticArray->release( jobs, &jobCapacity );
+	pending = prismaticArray->release( pending, &pendingCapacity );
+
+}
+
+// Insert a job after every job with the same or higher priority, so equal
+// priorities run in the order they were added
+static void insertJob( PrismJob* job ) {
+
+	PrismJob** grown = prismaticArray->reserve( jobs, &jobCapacity, jobCount + 1, sizeof( PrismJob* ) );
+	if( grown == NULL ) {
+		prismaticLogger->errorf( "Memory allocation failed for scheduling job '%s'", job->name );
+		free( job );
+		return;
+	}
+
+	jobs = grown;
+
+	size_t i = jobCount;
+	while( i > 0 && jobs[i - 1]->priority < job->priority ) {
+		jobs[i] = jobs[i - 1];
+		i--;
+	}
+
+	jobs[i] = job;
+	jobCount++;
+
+}
+
+// Free finished and cancelled jobs, then merge in jobs added while running
+static void sweepJobs( void ) {
+
+	// complete functions may add or cancel jobs, hold those until the sweep
+	// is done
+	ticking = true;
+
+	size_t kept = 0;
+	for( size_t i = 0; i < jobCount; i++ ) {
+
+		PrismJob* job = jobs[i];
+
+		if( !job->_cancelled && !job->_finished ) {
+			jobs[kept++] = job;
+			continue;
+		}
+
+		if( job->complete != NULL ) {
+			job->complete( job, job->_cancelled && !job->_finished );
+		}
+
+		free( job );
+
+	}
+
+	jobCount = kept;
+	ticking = false;
+
+	for( size_t i = 0; i < pendingCount; i++ ) {
+		insertJob( pending[i] );
+	}
+
+	pendingCount = 0;
+
+}
+
+static PrismJob* findJob( PrismJobId id ) {
+
+	for( size_t i = 0; i < jobCount; i++ ) {
+		if( jobs[i]->id == id && !jobs[i]->_cancelled && !jobs[i]->_finished ) {
+			return jobs[i];
+		}
+	}
+
+	for( size_t i = 0; i < pendingCount; i++ ) {
+		if( pending[i]->id == id && !pending[i]->_cancelled ) {
+			return pending[i];
+		}
+	}
+
+	return NULL;
+
+}
+
+const SchedulerFn* prismaticScheduler = &(SchedulerFn) {
+	.add = addJob,
+	.cancel = cancelJob,
+	.get = getJob,
+	.tick = tickScheduler,
+	.count = countJobs,
+	.logStats = logJobStats,
+	.clear = clearJobs,
+};
@@ -0,0 +1,125 @@
+#ifndef SCHEDULER_H
+#define SCHEDULER_H
+
+#ifndef STDBOOL_INCLUDED
+	#define STDBOOL_INCLUDED
+	#include <stdbool.h>
+#endif
+
+#ifndef STDDEF_INCLUDED
+	#define STDDEF_INCLUDED
+	#include <stddef.h>
+#endif
+
+#ifndef STDINT_INCLUDED
+	#define STDINT_INCLUDED
+	#include <stdint.h>
+#endif
+
+#ifndef TEXT_INCLUDED
+	#define TEXT_INCLUDED
+	#include "../text/text.h"
+#endif
+
+// Identifies a job for as long as it is scheduled. 0 is never a valid id.
+typedef uint32_t PrismJobId;
+
+// A resumable piece of work, run a step at a time in the time left over at
+// the end of each frame.
+typedef struct PrismJob {
+	PrismJobId id;
+	// Used for logging and stats, not copied
+	string name;
+	// Higher priority jobs run first each frame
+	int priority;
+	// Optional - Data for the job. Caller is responsible for freeing it,
+	// usually in complete.
+	void* data;
+
+	// Stats
+	// Number of steps run
+	unsigned int steps;
+	// Total time spent in step, in seconds
+	float totalTime;
+	// Longest single step, in seconds
+	float maxStepTime;
+
+	bool _cancelled;
+	bool _finished;
+
+	// Runs one step of the job. Should return quickly, the scheduler can only
+	// check the frame budget between steps. Return true when the job is done.
+	//
+	// ----
+	//
+	// PrismJob* self
+	bool ( *step )( struct PrismJob* );
+
+	// Optional - Called once when the job finishes or is cancelled, just
+	// before it is freed
+	//
+	// ----
+	//
+	// PrismJob* self
+	//
+	// bool cancelled - true if the job was cancelled before it finished
+	void ( *complete )( struct PrismJob*, bool );
+} PrismJob;
+
+typedef struct SchedulerFn {
+	// Schedule a new job
+	//
+	// The returned job is owned by the scheduler and freed once it finishes
+	// or is cancelled. Keep job->id rather than the pointer to refer to it
+	// later.
+	//
+	// ----
+	//
+	// string name
+	//
+	// int priority - Higher priority jobs run first each frame
+	//
+	// bool ( *step )( PrismJob* ) - Runs one step, returns true when done
+	//
+	// void* data
+	PrismJob* ( *add )( string, int, bool (*)( PrismJob* ), void* );
+
+	// Cancel a job. Its complete function is called with cancelled set.
+	//
+	// Returns false if no job with the id is scheduled.
+	//
+	// ----
+	//
+	// PrismJobId id
+	bool ( *cancel )( PrismJobId );
+
+	// Get a scheduled job by its id, or NULL if it has finished
+	//
+	// ----
+	//
+	// PrismJobId id
+	PrismJob* ( *get )( PrismJobId );
+
+	// Run job steps until budget seconds have passed or no jobs are left
+	//
+	// Jobs take turns one step at a time, in priority order. Called by the
+	// engine after each frame's update & draw with the time left in the frame.
+	//
+	// ----
+	//
+	// float budget - The time available, in seconds
+	void ( *tick )( float );
+
+	// Get the number of scheduled jobs
+	size_t ( *count )( void );
+
+	// Log the timing stats of every scheduled job
+	void ( *logStats )( void );
+
+	// Cancel every scheduled job
+	void ( *clear )( void );
+} SchedulerFn;
+
+extern const SchedulerFn* prismaticScheduler;
+
+#endif // SCHEDULER_H
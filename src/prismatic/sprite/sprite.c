@@ -1,6 +1,7 @@
 #include <stddef.h>
 #include <stdlib.h>
 #include <stdio.h>
+#include <string.h>
 
 #include "../prismatic.h"
 #include "sprite.h"
@@ -12,11 +13,63 @@ static void deleteSprite( PrismSprite* sp );
 static void freeImages( LCDBitmap** images );
 static LCDBitmap** loadImages( string* paths, size_t pathCount );
 static void setSpriteAnimation( PrismSprite* sp, PrismAnimation* animation );
+static PrismSprite* newFromTable( string path, float playSpeed );
+static PrismSprite* newFromSheet( string path, int frameWidth, int frameHeight, float playSpeed );
+static LCDBitmapTable* sliceSheet( LCDBitmap* sheet, int frameWidth, int frameHeight );
+static PrismSprite* newSprite( LCDBitmap* image );
+static PrismSprite* newSpriteFromTable( LCDBitmapTable* table, float playSpeed );
+static PrismSprite* newFromBitmapTable( LCDBitmapTable* table, float playSpeed );
 
 static PrismAnimation* newAnimation( LCDBitmap** frames, size_t startFrame, float playSpeed );
+static PrismAnimation* newAnimationFromTable( LCDBitmapTable* table, size_t startFrame, float playSpeed );
+static LCDBitmap* animationFrame( PrismAnimation* animation, size_t frame );
 static void deleteAnimation( PrismAnimation* animation );
 static void playAnimation( PrismAnimation* animation, float delta );
 static void playAnimationInOrder( PrismAnimation* animation, float delta, size_t* frameOrder, size_t frameCount );
+static int addClip( PrismAnimation* animation, string name, size_t start, size_t count, float playSpeed, bool looping );
+static int addClipSequence( PrismAnimation* animation, string name, size_t* sequence, size_t count, float playSpeed, bool looping );
+static int getClip( PrismAnimation* animation, string name );
+static void playClip( PrismAnimation* animation, int clipId );
+static void advanceAnimation( PrismAnimation* animation, float delta, size_t* position, size_t length, size_t* order );
+static size_t frameAt( PrismAnimation* animation, size_t* order, size_t position );
+static float frameDuration( PrismAnimation* animation, size_t frame );
+static float passDuration( PrismAnimation* animation, size_t* order, size_t length );
+static void setDurations( PrismAnimation* animation, float* durations );
+
+static PrismSpritePool* newSpritePool( LCDBitmap** frames, size_t capacity, float playSpeed );
+static PrismSpritePool* newSpritePoolFromTable( string path, size_t capacity, float playSpeed );
+static PrismSprite* acquireSprite( PrismSpritePool* pool );
+static void releaseSprite( PrismSpritePool* pool, PrismSprite* sp );
+static size_t availableSprites( PrismSpritePool* pool );
+static void deleteSpritePool( PrismSpritePool* pool );
+static PrismSpritePool* allocSpritePool( size_t capacity );
+static bool addPooledSprite( PrismSpritePool* pool, PrismSprite* sp );
+static void restartAnimation( PrismAnimation* animation );
+static PrismClip* newClip( PrismAnimation* animation, string name, size_t count, float playSpeed, bool looping );
+static size_t clipFrame( PrismClip* clip, size_t position );
+static void tickAnimations( float delta );
+static size_t countImageSwaps( void );
+static PrismAnimation* allocAnimation( void );
+static void freeAnimation( PrismAnimation* animation );
+static void releaseAnimationBlocks( void );
+static void showFrame( PrismAnimation* animation, LCDBitmap* image );
+
+// Animations are pooled in fixed size blocks, so they never move once 
+// created and tickAll walks them in memory order
+#define ANIMATION_BLOCK_SIZE 32
+
+static PrismAnimation** animationBlocks = NULL;
+static size_t animationBlockCount = 0;
+static size_t animationBlockCapacity = 0;
+
+// Unused slots, linked through _nextFree
+static PrismAnimation* freeAnimations = NULL;
+static size_t liveAnimations = 0;
+static bool tickingAnimations = false;
+
+// Sprite image changes since the last tickAll, and up to the end of it
+static size_t pendingSwaps = 0;
+static size_t lastSwaps = 0;
 
 // Sprites
 
@@ -60,8 +113,6 @@ static PrismSprite* newFromPath( string* path, size_t pathCount, float playSpeed
 }
 
 static PrismSprite* newFromImages( LCDBitmap** frames, size_t startFrame, float playSpeed ) {
-	
-	PrismSprite* s = sys->realloc( NULL, sizeof(PrismSprite));
 
 	size_t frameCount = 0;
 	while( frames[frameCount] != NULL ) {
@@ -78,20 +129,174 @@ static PrismSprite* newFromImages( LCDBitmap** frames, size_t startFrame, float
 		return NULL;
 	}
 
-	LCDBitmap* image = frames[startFrame];
-	s->sprite = newLCDSprite( image );
-
-	s->id = NULL;
-	s->animation = NULL;
+	PrismSprite* s = newSprite( frames[startFrame] );
+	if( s == NULL ) {
+		return NULL;
+	}
 
 	if( frameCount > 1 ) {
 		s->animation = newAnimation( frames, startFrame, playSpeed );
 		s->animation->sprite = s;
 	}
-	
+
+	return s;
+
+}
+
+// Create a Sprite showing the first frame of a table, with an Animation if 
+// the table has more than one frame
+static PrismSprite* newSpriteFromTable( LCDBitmapTable* table, float playSpeed ) {
+
+	int frameCount = 0;
+	graphics->getBitmapTableInfo( table, &frameCount, NULL );
+
+	if( frameCount < 1 ) {
+		prismaticLogger->error( "Cannot create Sprite from an empty bitmap table" );
+		return NULL;
+	}
+
+	PrismSprite* s = newSprite( graphics->getTableBitmap( table, 0 ) );
+	if( s == NULL ) {
+		return NULL;
+	}
+
+	s->table = table;
+
+	if( frameCount > 1 ) {
+		s->animation = newAnimationFromTable( table, 0, playSpeed );
+		s->animation->sprite = s;
+	}
+
+	return s;
+
+}
+
+static PrismSprite* newFromBitmapTable( LCDBitmapTable* table, float playSpeed ) {
+
+	if( table == NULL ) {
+		prismaticLogger->error( "Cannot create Sprite from NULL bitmap table" );
+		return NULL;
+	}
+
+	return newSpriteFromTable( table, playSpeed );
+
+}
+
+static PrismSprite* newFromTable( string path, float playSpeed ) {
+
+	const char* err = NULL;
+
+	LCDBitmapTable* table = prismaticAssets->loadBitmapTable( path, &err );
+	if( table == NULL ) {
+		prismaticLogger->errorf( "Could not load bitmap table '%s': %s", path, err != NULL ? err : "not found" );
+		return NULL;
+	}
+
+	PrismSprite* s = newSpriteFromTable( table, playSpeed );
+	if( s == NULL ) {
+		prismaticAssets->releaseTable( table );
+		return NULL;
+	}
+
+	return s;
+
+}
+
+static PrismSprite* newFromSheet( string path, int frameWidth, int frameHeight, float playSpeed ) {
+
+	const char* err = NULL;
+
+	LCDBitmap* sheet = prismaticAssets->loadBitmap( path, &err );
+	if( sheet == NULL ) {
+		prismaticLogger->errorf( "Could not load sprite sheet '%s': %s", path, err != NULL ? err : "not found" );
+		return NULL;
+	}
+
+	// The frames are copied into the table, the sheet is not needed after
+	LCDBitmapTable* table = sliceSheet( sheet, frameWidth, frameHeight );
+	prismaticAssets->release( sheet );
+
+	if( table == NULL ) {
+		prismaticLogger->errorf( "Could not slice sprite sheet '%s' into %dx%d frames", path, frameWidth, frameHeight );
+		return NULL;
+	}
+
+	PrismSprite* s = newSpriteFromTable( table, playSpeed );
+	if( s == NULL ) {
+		graphics->freeBitmapTable( table );
+		return NULL;
+	}
+
+	return s;
+
+}
+
+// Copy each frameWidth x frameHeight cell of a sheet, left to right then top
+// to bottom, into a new table
+static LCDBitmapTable* sliceSheet( LCDBitmap* sheet, int frameWidth, int frameHeight ) {
+
+	if( frameWidth <= 0 || frameHeight <= 0 ) {
+		return NULL;
+	}
+
+	int width = 0, height = 0;
+	graphics->getBitmapData( sheet, &width, &height, NULL, NULL, NULL );
+
+	int columns = width / frameWidth;
+	int rows = height / frameHeight;
+
+	if( columns < 1 || rows < 1 ) {
+		return NULL;
+	}
+
+	LCDBitmapTable* table = graphics->newBitmapTable( columns * rows, frameWidth, frameHeight );
+	if( table == NULL ) {
+		return NULL;
+	}
+
+	for( int i = 0; i < columns * rows; i++ ) {
+
+		LCDBitmap* frame = graphics->getTableBitmap( table, i );
+
+		graphics->pushContext( frame );
+		graphics->clear( kColorClear );
+		graphics->drawBitmap( sheet, -( i % columns ) * frameWidth, -( i / columns ) * frameHeight, kBitmapUnflipped );
+		graphics->popContext();
+
+	}
+
+	return table;
+
+}
+
+static PrismSprite* newSprite( LCDBitmap* image ) {
+
+	PrismSprite* s = sys->realloc( NULL, sizeof(PrismSprite));
+	if( s == NULL ) {
+		prismaticLogger->error( "Could not allocate memory for new Sprite" );
+		return NULL;
+	}
+
+	s->sprite = newLCDSprite( image );
+
+	s->id = NULL;
+	s->animation = NULL;
+	s->table = NULL;
 	s->update = NULL;
 	s->destroy = NULL;
 	s->imgs = NULL;
+	s->ref = NULL;
+	s->_sceneRefs = 0;
+	s->_persistent = false;
+	s->group = NULL;
+	s->groupIndex = 0;
+	s->activation = PrismActivation_Always;
+	s->dormant = false;
+	s->_updating = false;
+	s->_gridScene = NULL;
+	s->_awakeFrame = 0;
+	s->pool = NULL;
+	s->_acquired = false;
 
 	return s;
 
@@ -99,6 +304,11 @@ static PrismSprite* newFromImages( LCDBitmap** frames, size_t startFrame, float
 
 static void deleteSprite( PrismSprite* s ) {
 
+	if( s->pool != NULL ) {
+		prismaticLogger->errorf( "Sprite '%s' belongs to a pool and cannot be deleted, release it instead", s->id != NULL ? s->id : "" );
+		return;
+	}
+
 	if( s->destroy != NULL ) {
 		s->destroy( s );
 	}
@@ -121,6 +331,10 @@ static void deleteSprite( PrismSprite* s ) {
 		freeImages( s->imgs );
 	}
 
+	if( s->table != NULL && !prismaticAssets->releaseTable( s->table ) ) {
+		graphics->freeBitmapTable( s->table );
+	}
+
 	s = sys->realloc( s, 0 );
 	s = NULL;
 
@@ -132,8 +346,11 @@ static void freeImages( LCDBitmap** images ) {
 		return;
 	}
 
+	// Bitmaps loaded through the cache may still be used by other Sprites
 	for( size_t i = 0; images[i] != NULL; i++ ) {
-		graphics->freeBitmap( images[i] );
+		if( !prismaticAssets->release( images[i] ) ) {
+			graphics->freeBitmap( images[i] );
+		}
 	}
 
 	sys->realloc( images, 0 );
@@ -145,20 +362,26 @@ static LCDBitmap** loadImages( string* paths, size_t pathCount ) {
 
 	const char *outErr = NULL;
 	size_t imgCount = 0;
-	LCDBitmap** images = sys->realloc( NULL, sizeof(LCDBitmap*) );
+	size_t capacity = 0;
+
+	// The number of paths is known up front, so size the array once
+	LCDBitmap** images = prismaticArray->reserve( NULL, &capacity, pathCount + 1, sizeof(LCDBitmap*) );
+	if( images == NULL ) {
+		prismaticLogger->error( "Could not allocate memory for images" );
+		return NULL;
+	}
 
 	for( size_t i = 0; i < pathCount; i++ ) {
 
 		string path = paths[i];
 
-		LCDBitmap *img = pd->graphics->loadBitmap( path, &outErr );
-		if ( outErr != NULL ) {
-			prismaticLogger->errorf( "Error loading image at path '%s': %s", path, outErr );
+		LCDBitmap *img = prismaticAssets->loadBitmap( path, &outErr );
+		if ( img == NULL ) {
+			prismaticLogger->errorf( "Error loading image at path '%s': %s", path, outErr != NULL ? outErr : "not found" );
 			continue;
 		}
 
 		imgCount += 1;
-		images = sys->realloc( images, imgCount * sizeof(LCDBitmap*) + 1 );
 		images[imgCount - 1] = img;
 
 	}
@@ -193,14 +416,15 @@ const SpriteFn* prismaticSprite = &(SpriteFn) {
 	.newFromImages = newFromImages,
 	.delete = deleteSprite,
 	.setAnimation = setSpriteAnimation,
+	.newFromTable = newFromTable,
+	.newFromSheet = newFromSheet,
+	.newFromBitmapTable = newFromBitmapTable,
 };
 
 // Animations
 
 static PrismAnimation* newAnimation( LCDBitmap** frames, size_t startFrame, float playSpeed ) {
 
-	PrismAnimation* animation = calloc( 1, sizeof( PrismAnimation ) );
-
 	size_t frameCount = 0;
 	while( frames[frameCount] != NULL ) {
 		frameCount++;
@@ -216,25 +440,95 @@ static PrismAnimation* newAnimation( LCDBitmap** frames, size_t startFrame, floa
 		return NULL;
 	}
 
+	PrismAnimation* animation = allocAnimation();
+	if( animation == NULL ) {
+		return NULL;
+	}
+
 	animation->frames = frames;
 	animation->frameCount = frameCount;
 	animation->currentFrame = startFrame;
+	animation->_position = startFrame;
 	animation->playSpeed = playSpeed;
 	animation->looping = true; 
 	animation->paused = false;
+	animation->autoPlay = false;
+	animation->clip = -1;
+
+	return animation;
+
+}
+
+static PrismAnimation* newAnimationFromTable( LCDBitmapTable* table, size_t startFrame, float playSpeed ) {
+
+	if( table == NULL ) {
+		prismaticLogger->error( "Cannot create Animation from NULL bitmap table" );
+		return NULL;
+	}
+
+	int frameCount = 0;
+	graphics->getBitmapTableInfo( table, &frameCount, NULL );
+
+	if( frameCount < 1 ) {
+		prismaticLogger->error( "Cannot create Animation with no frames" );
+		return NULL;
+	}
+
+	if( (size_t)frameCount <= startFrame ) {
+		prismaticLogger->errorf( "startFrame %d is out of bounds. frames size: %d", startFrame, frameCount );
+		return NULL;
+	}
+
+	PrismAnimation* animation = allocAnimation();
+	if( animation == NULL ) {
+		return NULL;
+	}
+
+	animation->table = table;
+	animation->frameCount = (size_t)frameCount;
+	animation->currentFrame = startFrame;
+	animation->_position = startFrame;
+	animation->playSpeed = playSpeed;
+	animation->looping = true;
+	animation->paused = false;
+	animation->autoPlay = false;
+	animation->clip = -1;
 
 	return animation;
 
 }
 
+// Look up a frame, from the Animation's table if it has one
+static LCDBitmap* animationFrame( PrismAnimation* animation, size_t frame ) {
+
+	if( animation->table != NULL ) {
+		return graphics->getTableBitmap( animation->table, (int)frame );
+	}
+
+	return animation->frames[frame];
+
+}
+
 static void deleteAnimation( PrismAnimation* animation ) {
 
+	for( size_t i = 0; i < animation->clipCount; i++ ) {
+		prismaticString->delete( animation->clips[i].name );
+		free( animation->clips[i].sequence );
+	}
+
+	animation->clips = prismaticArray->release( animation->clips, &animation->_clipCapacity );
+	animation->clipCount = 0;
+
+	free( animation->durations );
+	animation->durations = NULL;
+
 	animation->frameCount = 0;
 	animation->frames = NULL;
+	animation->table = NULL;
 	animation->currentFrame = 0;
 	animation->playSpeed = 0;
 
-	free( animation );
+	freeAnimation( animation );
 	animation = NULL;
 
 }
@@ -245,103 +539,732 @@ static void playAnimation( PrismAnimation* animation, float delta ) {
 		return;
 	}
 
-	animation->timer += delta;
+	size_t length = animation->clip >= 0 ? animation->clips[animation->clip].count : animation->frameCount;
+
+	advanceAnimation( animation, delta, &animation->_position, length, NULL );
+
+}
+
+static void playAnimationInOrder( PrismAnimation* animation, float delta, size_t* frameOrder, size_t frameCount ) {
+
+	if( animation->finished || animation->paused ) {
+		return;
+	}
+
+	if( frameOrder == NULL || frameCount < 1 ) {
+		prismaticLogger->error( "Cannot play Animation in an empty order" );
+		return;
+	}
+
+	// The order may have been shortened since the last call
+	if( animation->customOrderPtr >= frameCount ) {
+		animation->customOrderPtr = 0;
+	}
+
+	advanceAnimation( animation, delta, &animation->customOrderPtr, frameCount, frameOrder );
 
-	if( animation->timer < animation->playSpeed ) {
+}
+
+// Move an Animation through a run of length frames by delta seconds
+// 
+// Time left over after a frame change is kept toward the next one, so a long
+// delta can skip several frames and frame changes never drift. position is 
+// the shown frame's place in the run, mapped to a frame by order, or by the 
+// playing clip when order is NULL. The complete function is called at most 
+// once, after the new frame is shown.
+static void advanceAnimation( PrismAnimation* animation, float delta, size_t* position, size_t length, size_t* order ) {
+
+	if( animation->sprite == NULL ) {
+		prismaticLogger->errorf( "NULL Sprite in Animation" );
 		return;
 	}
 
-	if( animation->currentFrame >= animation->frameCount ) {
+	animation->timer += delta;
+
+	size_t steps = 0;
+	bool advanced = false;
+	bool completed = false;
+	float duration = frameDuration( animation, frameAt( animation, order, *position ) );
+
+	while( animation->timer >= duration ) {
+
+		// After a whole pass, only the time into the next pass matters
+		if( steps == length ) {
+
+			float pass = passDuration( animation, order, length );
+			if( pass <= 0 ) {
+				animation->timer = 0;
+				break;
+			}
+
+			animation->timer -= pass * (float)(unsigned int)( animation->timer / pass );
+			steps = 0;
+
+			if( animation->timer < duration ) {
+				break;
+			}
 
-		if( animation->complete != NULL ) {
-			animation->complete( animation );
 		}
 
-		if( animation->looping ) {
-			animation->currentFrame = 0;
-			return;
+		steps++;
+
+		if( *position + 1 < length ) {
+
+			(*position)++;
+
+		} else {
+
+			completed = true;
+
+			// One-shot Animations stay on their last frame
+			if( !animation->looping ) {
+				animation->finished = true;
+				animation->timer = 0;
+				break;
+			}
+
+			*position = 0;
+
 		}
-		
-		animation->finished = true;
 
-	} else {
+		animation->timer -= duration;
+		advanced = true;
+		duration = frameDuration( animation, frameAt( animation, order, *position ) );
+
+	}
 
-		LCDBitmap* nextFrame = animation->frames[animation->currentFrame];
+	if( advanced ) {
 
-		if ( nextFrame == NULL ) {
-			prismaticLogger->errorf( "NULL frame in Animation at [%d]", animation->currentFrame );
+		size_t frame = frameAt( animation, order, *position );
+
+		LCDBitmap* nextFrame = frame < animation->frameCount ? animationFrame( animation, frame ) : NULL;
+
+		if( nextFrame == NULL ) {
+			prismaticLogger->errorf( "NULL frame in Animation at [%d]", frame );
 			return;
 		}
 
-		if( animation->sprite == NULL ) {
-			prismaticLogger->errorf( "NULL Sprite in Animation" );
+		animation->currentFrame = frame;
+		showFrame( animation, nextFrame );
+
+	}
+
+	if( completed && animation->complete != NULL ) {
+		animation->complete( animation );
+	}
+
+}
+
+// The frame at a position of the run being played, see advanceAnimation
+static size_t frameAt( PrismAnimation* animation, size_t* order, size_t position ) {
+
+	if( order != NULL ) {
+		return order[position];
+	}
+
+	if( animation->clip >= 0 ) {
+		return clipFrame( &animation->clips[animation->clip], position );
+	}
+
+	return position;
+
+}
+
+static float frameDuration( PrismAnimation* animation, size_t frame ) {
+
+	if( animation->durations != NULL && frame < animation->frameCount ) {
+		return animation->durations[frame];
+	}
+
+	return animation->playSpeed;
+
+}
+
+// The time taken to play a whole run once
+static float passDuration( PrismAnimation* animation, size_t* order, size_t length ) {
+
+	float pass = 0;
+
+	for( size_t i = 0; i < length; i++ ) {
+		pass += frameDuration( animation, frameAt( animation, order, i ) );
+	}
+
+	return pass;
+
+}
+
+static void setDurations( PrismAnimation* animation, float* durations ) {
+
+	if( animation == NULL ) {
+		prismaticLogger->error( "Cannot set frame durations of NULL Animation" );
+		return;
+	}
+
+	if( durations == NULL ) {
+		free( animation->durations );
+		animation->durations = NULL;
+		return;
+	}
+
+	// Reuse the copy from an earlier call, the frame count never changes
+	if( animation->durations == NULL ) {
+
+		animation->durations = malloc( animation->frameCount * sizeof( float ) );
+		if( animation->durations == NULL ) {
+			prismaticLogger->error( "Could not allocate memory for frame durations" );
 			return;
 		}
 
-		sprites->setImage( animation->sprite->sprite, animation->frames[animation->currentFrame], kBitmapUnflipped );
-		
-		animation->timer = 0;
-		animation->currentFrame++;
+	}
+
+	memcpy( animation->durations, durations, animation->frameCount * sizeof( float ) );
+
+}
+
+static int addClip( PrismAnimation* animation, string name, size_t start, size_t count, float playSpeed, bool looping ) {
 
+	if( animation == NULL ) {
+		prismaticLogger->error( "Cannot add clip to NULL Animation" );
+		return -1;
+	}
+
+	if( start >= animation->frameCount || count > animation->frameCount - start ) {
+		prismaticLogger->errorf( "Clip '%s' frames %d-%d are out of bounds. frames size: %d", name, start, start + count, animation->frameCount );
+		return -1;
 	}
 
+	PrismClip* clip = newClip( animation, name, count, playSpeed, looping );
+	if( clip == NULL ) {
+		return -1;
+	}
+
+	clip->start = start;
+
+	return (int)animation->clipCount - 1;
+
 }
 
-static void playAnimationInOrder( PrismAnimation* animation, float delta, size_t* frameOrder, size_t frameCount ) {
+static int addClipSequence( PrismAnimation* animation, string name, size_t* sequence, size_t count, float playSpeed, bool looping ) {
+
+	if( animation == NULL ) {
+		prismaticLogger->error( "Cannot add clip to NULL Animation" );
+		return -1;
+	}
+
+	if( sequence == NULL ) {
+		prismaticLogger->errorf( "Cannot add clip '%s' with NULL sequence", name );
+		return -1;
+	}
+
+	for( size_t i = 0; i < count; i++ ) {
+		if( sequence[i] >= animation->frameCount ) {
+			prismaticLogger->errorf( "Clip '%s' frame %d is out of bounds. frames size: %d", name, sequence[i], animation->frameCount );
+			return -1;
+		}
+	}
+
+	size_t* copy = malloc( count * sizeof( size_t ) );
+	if( copy == NULL ) {
+		prismaticLogger->errorf( "Could not allocate memory for clip '%s'", name );
+		return -1;
+	}
+
+	memcpy( copy, sequence, count * sizeof( size_t ) );
+
+	PrismClip* clip = newClip( animation, name, count, playSpeed, looping );
+	if( clip == NULL ) {
+		free( copy );
+		return -1;
+	}
+
+	clip->sequence = copy;
 
-	if( animation->finished ) {
+	return (int)animation->clipCount - 1;
+
+}
+
+// Clips are looked up once, and an Animation has only a handful of them, so 
+// a scan is all that is needed
+static int getClip( PrismAnimation* animation, string name ) {
+
+	if( animation == NULL || name == NULL ) {
+		return -1;
+	}
+
+	for( size_t i = 0; i < animation->clipCount; i++ ) {
+		if( strcmp( animation->clips[i].name, name ) == 0 ) {
+			return (int)i;
+		}
+	}
+
+	return -1;
+
+}
+
+static void playClip( PrismAnimation* animation, int clipId ) {
+
+	if( animation == NULL ) {
+		prismaticLogger->error( "Cannot play clip of NULL Animation" );
 		return;
 	}
 
-	animation->timer += delta;
+	if( clipId < 0 || (size_t)clipId >= animation->clipCount ) {
+		prismaticLogger->errorf( "Clip %d is out of bounds. clips size: %d", clipId, animation->clipCount );
+		return;
+	}
 
-	if( animation->timer < animation->playSpeed ) {
+	if( animation->clip == clipId && !animation->finished ) {
 		return;
 	}
 
-	if( animation->currentFrame >= animation->frameCount || animation->customOrderPtr >= frameCount ) {
+	PrismClip* clip = &animation->clips[clipId];
 
-		if( animation->complete != NULL ) {
-			animation->complete( animation );
-		}
+	animation->clip = clipId;
+	animation->playSpeed = clip->playSpeed;
+	animation->looping = clip->looping;
+	animation->finished = false;
+	animation->timer = 0;
+	animation->currentFrame = clipFrame( clip, 0 );
+	animation->_position = 0;
+
+	if( animation->sprite != NULL ) {
+		showFrame( animation, animationFrame( animation, animation->currentFrame ) );
+	}
+
+}
+
+// Append a clip with no frames set yet
+static PrismClip* newClip( PrismAnimation* animation, string name, size_t count, float playSpeed, bool looping ) {
+
+	if( name == NULL ) {
+		prismaticLogger->error( "Cannot add clip with NULL name" );
+		return NULL;
+	}
+
+	if( count < 1 ) {
+		prismaticLogger->errorf( "Cannot add clip '%s' with no frames", name );
+		return NULL;
+	}
+
+	if( getClip( animation, name ) >= 0 ) {
+		prismaticLogger->errorf( "Animation already has a clip named '%s'", name );
+		return NULL;
+	}
+
+	PrismClip* clips = prismaticArray->reserve( animation->clips, &animation->_clipCapacity, animation->clipCount + 1, sizeof( PrismClip ) );
+	if( clips == NULL ) {
+		prismaticLogger->errorf( "Memory allocation failed for clip '%s'", name );
+		return NULL;
+	}
+
+	animation->clips = clips;
+
+	string nameCopy = prismaticString->new( name );
+	if( nameCopy == NULL ) {
+		return NULL;
+	}
+
+	PrismClip* clip = &animation->clips[animation->clipCount++];
+
+	clip->name = nameCopy;
+	clip->start = 0;
+	clip->count = count;
+	clip->sequence = NULL;
+	clip->playSpeed = playSpeed;
+	clip->looping = looping;
+
+	return clip;
+
+}
+
+// The frame shown at a position within a clip
+static size_t clipFrame( PrismClip* clip, size_t position ) {
+	return clip->sequence != NULL ? clip->sequence[position] : clip->start + position;
+}
+
+static void tickAnimations( float delta ) {
+
+	tickingAnimations = true;
+
+	// A complete function may create Animations, adding blocks, so re-check 
+	// the block count each time
+	for( size_t b = 0; b < animationBlockCount; b++ ) {
+
+		PrismAnimation* block = animationBlocks[b];
+
+		for( size_t i = 0; i < ANIMATION_BLOCK_SIZE; i++ ) {
+
+			PrismAnimation* animation = &block[i];
+
+			if( !animation->_live || animation->sprite == NULL ) {
+				continue;
+			}
+
+			// Only Sprites of Scenes that updated this frame animate, not those
+			// of preloaded, frozen or exited Scenes
+			bool updating = animation->sprite->_updating;
+			animation->sprite->_updating = false;
+
+			if( !updating || !animation->autoPlay ) {
+				continue;
+			}
+
+			playAnimation( animation, delta );
 
-		if( animation->looping ) {
-			animation->currentFrame = frameOrder[0];
-			animation->customOrderPtr = 0;
-			return;
 		}
-		
-		animation->finished = true;
 
-	} else {
+	}
 
-		LCDBitmap* nextFrame = animation->frames[animation->currentFrame];
+	tickingAnimations = false;
 
-		if ( nextFrame == NULL ) {
-			prismaticLogger->errorf( "NULL frame in Animation at [%d]", animation->currentFrame );
-			return;
+	lastSwaps = pendingSwaps;
+	pendingSwaps = 0;
+
+	if( liveAnimations == 0 ) {
+		releaseAnimationBlocks();
+	}
+
+}
+
+static size_t countImageSwaps( void ) {
+	return lastSwaps;
+}
+
+// Take a zeroed slot from the pool, adding a block if none are left
+static PrismAnimation* allocAnimation( void ) {
+
+	if( freeAnimations == NULL ) {
+
+		PrismAnimation** blocks = prismaticArray->reserve( animationBlocks, &animationBlockCapacity, animationBlockCount + 1, sizeof( PrismAnimation* ) );
+		if( blocks == NULL ) {
+			prismaticLogger->error( "Memory allocation failed for Animation pool" );
+			return NULL;
 		}
 
-		if( animation->sprite == NULL ) {
-			prismaticLogger->errorf( "NULL Sprite in Animation" );
-			return;
+		animationBlocks = blocks;
+
+		PrismAnimation* block = calloc( ANIMATION_BLOCK_SIZE, sizeof( PrismAnimation ) );
+		if( block == NULL ) {
+			prismaticLogger->error( "Could not allocate memory for new Animation" );
+			return NULL;
 		}
 
-		sprites->setImage( animation->sprite->sprite, animation->frames[animation->currentFrame], kBitmapUnflipped );
-		
-		animation->timer = 0;
-		animation->customOrderPtr++;
-		animation->currentFrame = frameOrder[animation->customOrderPtr];
+		animationBlocks[animationBlockCount++] = block;
+
+		// Link back to front, so slots are handed out in memory order
+		for( size_t i = ANIMATION_BLOCK_SIZE; i-- > 0; ) {
+			block[i]._nextFree = freeAnimations;
+			freeAnimations = &block[i];
+		}
 
 	}
 
+	PrismAnimation* animation = freeAnimations;
+	freeAnimations = animation->_nextFree;
+
+	memset( animation, 0, sizeof( PrismAnimation ) );
+	animation->_live = true;
+	liveAnimations++;
+
+	return animation;
+
+}
+
+static void freeAnimation( PrismAnimation* animation ) {
+
+	animation->_live = false;
+	animation->sprite = NULL;
+	animation->_nextFree = freeAnimations;
+	freeAnimations = animation;
+	liveAnimations--;
+
+	// tickAll is still walking the blocks, it releases them once done
+	if( liveAnimations == 0 && !tickingAnimations ) {
+		releaseAnimationBlocks();
+	}
+
+}
+
+// Free every block but the first once no Animation is live, so a game that
+// frees and recreates its only Animations does not re-allocate a block each
+// time
+static void releaseAnimationBlocks( void ) {
+
+	if( animationBlockCount <= 1 ) {
+		return;
+	}
+
+	for( size_t b = 1; b < animationBlockCount; b++ ) {
+		free( animationBlocks[b] );
+		animationBlocks[b] = NULL;
+	}
+
+	animationBlockCount = 1;
+	freeAnimations = NULL;
+
+	PrismAnimation* block = animationBlocks[0];
+	for( size_t i = ANIMATION_BLOCK_SIZE; i-- > 0; ) {
+		block[i]._nextFree = freeAnimations;
+		freeAnimations = &block[i];
+	}
+
+}
+
+// Set the Animation's Sprite to a frame, unless it is already showing it
+static void showFrame( PrismAnimation* animation, LCDBitmap* image ) {
+
+	LCDSprite* sp = animation->sprite->sprite;
+
+	if( sprites->getImage( sp ) == image ) {
+		return;
+	}
+
+	sprites->setImage( sp, image, kBitmapUnflipped );
+	pendingSwaps++;
+
 }
 
 const AnimationFn* prismaticAnimation = &(AnimationFn) {
 	.new = newAnimation,
+	.newFromTable = newAnimationFromTable,
 	.delete = deleteAnimation,
 	.play = playAnimation,
 	.playInOrder = playAnimationInOrder,
+	.addClip = addClip,
+	.addClipSequence = addClipSequence,
+	.getClip = getClip,
+	.playClip = playClip,
+	.tickAll = tickAnimations,
+	.imageSwaps = countImageSwaps,
+	.setDurations = setDurations,
 };
 
-// Animations
\ No newline at end of file
+// Sprite Pools
+
+static PrismSpritePool* newSpritePool( LCDBitmap** frames, size_t capacity, float playSpeed ) {
+
+	if( frames == NULL ) {
+		prismaticLogger->error( "Cannot create Sprite pool with NULL frames" );
+		return NULL;
+	}
+
+	PrismSpritePool* pool = allocSpritePool( capacity );
+	if( pool == NULL ) {
+		return NULL;
+	}
+
+	for( size_t i = 0; i < capacity; i++ ) {
+
+		if( !addPooledSprite( pool, newFromImages( frames, 0, playSpeed ) ) ) {
+			deleteSpritePool( pool );
+			return NULL;
+		}
+
+	}
+
+	return pool;
+
+}
+
+static PrismSpritePool* newSpritePoolFromTable( string path, size_t capacity, float playSpeed ) {
+
+	PrismSpritePool* pool = allocSpritePool( capacity );
+	if( pool == NULL ) {
+		return NULL;
+	}
+
+	// Each Sprite holds its own reference to the cached table
+	for( size_t i = 0; i < capacity; i++ ) {
+
+		if( !addPooledSprite( pool, newFromTable( path, playSpeed ) ) ) {
+			deleteSpritePool( pool );
+			return NULL;
+		}
+
+	}
+
+	return pool;
+
+}
+
+static PrismSprite* acquireSprite( PrismSpritePool* pool ) {
+
+	if( pool == NULL ) {
+		prismaticLogger->error( "Cannot acquire Sprite from NULL pool" );
+		return NULL;
+	}
+
+	// Running out is expected under load, so this is not logged
+	if( pool->_freeCount == 0 ) {
+		return NULL;
+	}
+
+	PrismSprite* s = pool->_free[--pool->_freeCount];
+
+	s->_acquired = true;
+
+	if( s->animation != NULL ) {
+		restartAnimation( s->animation );
+	}
+
+	sprites->setVisible( s->sprite, 1 );
+	sprites->addSprite( s->sprite );
+
+	return s;
+
+}
+
+static void releaseSprite( PrismSpritePool* pool, PrismSprite* s ) {
+
+	if( pool == NULL || s == NULL ) {
+		prismaticLogger->error( "Cannot release NULL Sprite or release to NULL pool" );
+		return;
+	}
+
+	if( s->pool != pool || !s->_acquired ) {
+		prismaticLogger->errorf( "Sprite '%s' was not acquired from this pool", s->id != NULL ? s->id : "" );
+		return;
+	}
+
+	if( s->_sceneRefs > 0 ) {
+		prismaticLogger->errorf( "Sprite '%s' must be removed from its Scenes before it is released", s->id != NULL ? s->id : "" );
+		return;
+	}
+
+	s->_acquired = false;
+
+	sprites->setVisible( s->sprite, 0 );
+	sprites->removeSprite( s->sprite );
+
+	// Stop tickAll from animating a hidden Sprite
+	if( s->animation != NULL ) {
+		s->animation->paused = true;
+	}
+
+	pool->_free[pool->_freeCount++] = s;
+
+}
+
+static size_t availableSprites( PrismSpritePool* pool ) {
+	return pool != NULL ? pool->_freeCount : 0;
+}
+
+static void deleteSpritePool( PrismSpritePool* pool ) {
+
+	if( pool == NULL ) {
+		return;
+	}
+
+	for( size_t i = 0; i < pool->capacity; i++ ) {
+
+		PrismSprite* s = pool->sprites[i];
+		if( s == NULL ) {
+			continue;
+		}
+
+		s->pool = NULL;
+
+		// Acquired Sprites may still be in use or held by a Scene, they are 
+		// left to whoever holds them
+		if( s->_acquired ) {
+			s->_acquired = false;
+			continue;
+		}
+
+		deleteSprite( s );
+
+	}
+
+	free( pool->sprites );
+	free( pool->_free );
+	free( pool );
+
+}
+
+// A pool with room for capacity Sprites, filled by addPooledSprite
+static PrismSpritePool* allocSpritePool( size_t capacity ) {
+
+	if( capacity < 1 ) {
+		prismaticLogger->error( "Cannot create Sprite pool with no capacity" );
+		return NULL;
+	}
+
+	PrismSpritePool* pool = calloc( 1, sizeof( PrismSpritePool ) );
+	if( pool == NULL ) {
+		prismaticLogger->error( "Could not allocate memory for new Sprite pool" );
+		return NULL;
+	}
+
+	pool->sprites = calloc( capacity, sizeof( PrismSprite* ) );
+	pool->_free = calloc( capacity, sizeof( PrismSprite* ) );
+
+	if( pool->sprites == NULL || pool->_free == NULL ) {
+		prismaticLogger->error( "Could not allocate memory for new Sprite pool" );
+		free( pool->sprites );
+		free( pool->_free );
+		free( pool );
+		return NULL;
+	}
+
+	pool->capacity = capacity;
+
+	return pool;
+
+}
+
+// Park a newly created Sprite in the pool, hidden and off the display list
+static bool addPooledSprite( PrismSpritePool* pool, PrismSprite* s ) {
+
+	if( s == NULL ) {
+		prismaticLogger->error( "Could not create Sprite for pool" );
+		return false;
+	}
+
+	// An id of its own, so Scenes never have to copy a new one in
+	char id[48];
+	snprintf( id, sizeof( id ), "pool-%p-%u", (void*)pool, (unsigned int)pool->_freeCount );
+
+	s->id = prismaticString->new( id );
+	if( s->id == NULL ) {
+		prismaticLogger->error( "Could not allocate memory for pooled Sprite id" );
+		s->pool = NULL;
+		deleteSprite( s );
+		return false;
+	}
+
+	s->pool = pool;
+	sprites->setVisible( s->sprite, 0 );
+
+	if( s->animation != NULL ) {
+		s->animation->paused = true;
+	}
+
+	pool->sprites[pool->_freeCount] = s;
+	pool->_free[pool->_freeCount] = s;
+	pool->_freeCount++;
+
+	return true;
+
+}
+
+// Go back to the first frame of the playing clip, or of the Animation
+static void restartAnimation( PrismAnimation* animation ) {
+
+	animation->timer = 0;
+	animation->_position = 0;
+	animation->finished = false;
+	animation->paused = false;
+	animation->currentFrame = animation->clip >= 0 ? clipFrame( &animation->clips[animation->clip], 0 ) : 0;
+
+	showFrame( animation, animationFrame( animation, animation->currentFrame ) );
+
+}
+
+const SpritePoolFn* prismaticSpritePool = &(SpritePoolFn) {
+	.new = newSpritePool,
+	.newFromTable = newSpritePoolFromTable,
+	.acquire = acquireSprite,
+	.release = releaseSprite,
+	.available = availableSprites,
+	.delete = deleteSpritePool,
+};
@@ -12,6 +12,11 @@
 	#define STDDEF_INCLUDED
 #endif
 
+#ifndef STDINT_INCLUDED
+	#include <stdint.h>
+	#define STDINT_INCLUDED
+#endif
+
 #ifndef PD_API_INCLUDED 
 	#include "pd_api.h"  
 	#define PD_API_INCLUDED  
@@ -24,32 +29,125 @@
 
 typedef struct PrismSprite PrismSprite;
 typedef struct PrismAnimation PrismAnimation;
+typedef struct PrismUpdateGroup PrismUpdateGroup;
+typedef struct PrismSpritePool PrismSpritePool;
 typedef struct SpriteFn SpriteFn;
 
+// When a Sprite in a Scene is updated, see prismaticScene->setActivation
+typedef enum {
+	// Update every frame
+	PrismActivation_Always,
+	// Update only while near the Scene's camera
+	PrismActivation_NearCamera,
+	// Never update
+	PrismActivation_Never,
+} PrismActivation;
+
 typedef struct PrismSprite {
 	string id;
 	LCDSprite* sprite;
 	LCDBitmap** imgs;
+	// For Sprites created from a table or sheet, the table holding their 
+	// frames. Freed with the Sprite.
+	LCDBitmapTable* table;
 	PrismAnimation* animation;
 	void* ref;
+	// The number of Scenes the Sprite has been added to
+	size_t _sceneRefs;
+	// Set while the Sprite is owned by a SceneManager as a persistent Sprite
+	bool _persistent;
+	// The update group the Sprite belongs to, see prismaticScene->joinGroup.
+	// Read only.
+	PrismUpdateGroup* group;
+	// The Sprite's index into its group's arrays. Read only, changes as 
+	// other members leave the group.
+	size_t groupIndex;
+	// Read only, set with prismaticScene->setActivation
+	PrismActivation activation;
+	// Set while the Sprite is skipped by its Scene's update. Read only.
+	bool dormant;
+	// Set when a Scene or the SceneManager updates the Sprite, cleared by
+	// the next prismaticAnimation->tickAll
+	bool _updating;
+	// Activation grid cell, see Scene
+	int32_t _cellX;
+	int32_t _cellY;
+	size_t _cellSlot;
+	// The Scene whose activation grid holds the Sprite, NULL if none does
+	struct Scene* _gridScene;
+	uint32_t _awakeFrame;
+	// The pool the Sprite belongs to, see prismaticSpritePool. Read only.
+	PrismSpritePool* pool;
+	// Set while the Sprite is acquired from its pool
+	bool _acquired;
 	void ( *update )( PrismSprite*, float );
 	void ( *destroy )( PrismSprite* );
 } PrismSprite;
 
+// A named run of an Animation's frames with its own speed and loop mode, 
+// see prismaticAnimation->addClip
+typedef struct PrismClip {
+	// Owned copy of the clip's name
+	string name;
+	// The first frame of the clip. Unused when sequence is set.
+	size_t start;
+	// The number of frames in the clip
+	size_t count;
+	// Optional - Owned copy of the frame indexes to play, in order
+	size_t* sequence;
+	float playSpeed;
+	bool looping;
+} PrismClip;
+
 typedef struct PrismAnimation {
 	LCDBitmap** frames;
+	// Set instead of frames for Animations created from a table
+	LCDBitmapTable* table;
 	size_t frameCount;
+	// The frame being shown
 	size_t currentFrame;
 	size_t customOrderPtr;
 	float playSpeed;
+	// Optional - Seconds to show each frame, replacing playSpeed. Read only,
+	// set with prismaticAnimation->setDurations.
+	float* durations;
 	PrismSprite* sprite;
 	bool looping;
 	bool finished;
 	bool paused;
+	// Advance the Animation from prismaticAnimation->tickAll instead of by
+	// hand. Default: false
+	bool autoPlay;
 	float timer;
+	// Clips defined over frames, see prismaticAnimation->addClip
+	PrismClip* clips;
+	size_t clipCount;
+	size_t _clipCapacity;
+	// The id of the clip being played, or -1 when playing every frame. Read 
+	// only, set with prismaticAnimation->playClip.
+	int clip;
+	// Position of the shown frame within the clip, or within frames when no
+	// clip is playing
+	size_t _position;
+	// Set while the Animation's pool slot is in use
+	bool _live;
+	// The next unused pool slot, while this one is unused
+	struct PrismAnimation* _nextFree;
+	// Optional - Called each time the last frame's time runs out, at most 
+	// once per update
 	void ( *complete )( PrismAnimation* );
 } PrismAnimation;
 
+// Sprites created up front and reused, see prismaticSpritePool
+typedef struct PrismSpritePool {
+	// Every Sprite of the pool, acquired or not
+	PrismSprite** sprites;
+	size_t capacity;
+	// Sprites waiting to be acquired, used as a stack
+	PrismSprite** _free;
+	size_t _freeCount;
+} PrismSpritePool;
+
 typedef struct SpriteFn {
 	// Create a new Sprite from the given paths
 	// 
@@ -81,6 +179,9 @@ typedef struct SpriteFn {
 
 	// Delete a Sprite
 	// 
+	// Sprites that belong to a pool are not deleted, see 
+	// prismaticSpritePool->delete.
+	// 
 	// First, calls sprite->destroy(), if it exists.
 	// 
 	// Then, removes the image from the underlying
@@ -99,6 +200,9 @@ typedef struct SpriteFn {
 
 	// Free an array of LCDBitmap*s used to create a Sprite.
 	// 
+	// Bitmaps loaded through prismaticAssets are released, and only freed 
+	// once nothing else uses them.
+	// 
 	// Generally, this should be called during Sprite or Scene destroy actions.
 	// If you choose to implement a game without Scenes, this should be called 
 	// when the game is destroyed.
@@ -110,7 +214,9 @@ typedef struct SpriteFn {
 
 	// Load images into an array of LCDBitmap*s
 	// 
-	// Caller is responsible for freeing the resulting images
+	// Images are loaded through prismaticAssets, so Sprites loaded from the 
+	// same paths share their bitmaps. Caller is responsible for freeing the 
+	// resulting images with prismaticSprite->freeImages.
 	// 
 	// ----
 	// 
@@ -127,6 +233,49 @@ typedef struct SpriteFn {
 	// 
 	// PrismAnimation* animation
 	void ( *setAnimation )( PrismSprite*, PrismAnimation* );
+
+	// Create a new Sprite from an image table, e.g. player-table-32-32.png
+	// 
+	// The whole animation is loaded with one file read, through 
+	// prismaticAssets so Sprites using the same table share it. Frames are 
+	// played in table order.
+	// 
+	// ----
+	// 
+	// string path - Path to the table, without the -table-W-H suffix or 
+	// extension. e.g. "assets/images/player"
+	// 
+	// float playSpeed - The number of seconds elapsed between frame changes
+	PrismSprite* ( *newFromTable )( string, float );
+
+	// Create a new Sprite from a sprite sheet cut into a grid of frames
+	// 
+	// The sheet is read once and copied into a table owned by the Sprite, 
+	// frames are numbered left to right, then top to bottom.
+	// 
+	// ----
+	// 
+	// string path - Path to the sheet. Do not include extension.
+	// 
+	// int frameWidth
+	// 
+	// int frameHeight
+	// 
+	// float playSpeed - The number of seconds elapsed between frame changes
+	PrismSprite* ( *newFromSheet )( string, int, int, float );
+
+	// Create a new Sprite from a bitmap table
+	// 
+	// The Sprite takes ownership of the table. It is released when the 
+	// Sprite is deleted if it was loaded through prismaticAssets, and freed 
+	// otherwise.
+	// 
+	// ----
+	// 
+	// LCDBitmapTable* table
+	// 
+	// float playSpeed - The number of seconds elapsed between frame changes
+	PrismSprite* ( *newFromBitmapTable )( LCDBitmapTable*, float );
 } SpriteFn;
 
 typedef struct AnimationFn {
@@ -141,16 +290,39 @@ typedef struct AnimationFn {
 	// float playSpeed - The number of seconds elapsed between frame changes
 	PrismAnimation* ( *new )( LCDBitmap**, size_t, float );
 
+	// Create a new PrismAnimation* whose frames are the bitmaps of a table, 
+	// in order
+	// 
+	// The table is not copied, caller is responsible for freeing it after 
+	// the Animation.
+	// 
+	// ----
+	// 
+	// LCDBitmapTable* table
+	// 
+	// size_t startFrame - The frame to start the Animation from
+	// 
+	// float playSpeed - The number of seconds elapsed between frame changes
+	PrismAnimation* ( *newFromTable )( LCDBitmapTable*, size_t, float );
+
 	// Delete a PrismAnimation*
 	// 
-	// Frees only the animation, frame images should be freed separately.
+	// Frees only the animation, frame images should be freed separately. 
+	// Only Animations created with new or newFromTable can be deleted.
 	// 
 	// ----
 	// 
 	// PrismAnimation* animation
 	void ( *delete )( PrismAnimation* );
 
-	// Play an Animation
+	// Advance an Animation by hand
+	// 
+	// Animations with autoPlay set are already advanced once per update by 
+	// prismaticAnimation->tickAll, playing them by hand as well advances them
+	// twice.
+	// 
+	// Time left over after a frame change counts toward the next one, so a 
+	// long delta can skip several frames.
 	// 
 	// ----
 	// 
@@ -161,6 +333,8 @@ typedef struct AnimationFn {
 
 	// Play an Animation in a specific order
 	// 
+	// Ignores the Animation's clips.
+	// 
 	// ----
 	// 
 	// PrismAnimation* animation
@@ -169,9 +343,188 @@ typedef struct AnimationFn {
 	// 
 	// size_t frameCount - The length of the frameOrder array
 	void ( *playInOrder )( PrismAnimation*, float, size_t*, size_t );
+
+	// Add a clip playing a range of an Animation's frames
+	// 
+	// Clips let one set of frames, e.g. a single table, hold every animation 
+	// of a Sprite. Look the returned id up once, then switch clips with 
+	// prismaticAnimation->playClip.
+	// 
+	// Returns the clip's id, or -1 if the clip could not be added.
+	// 
+	// ----
+	// 
+	// PrismAnimation* animation
+	// 
+	// string name - Must be unique within the Animation, copied
+	// 
+	// size_t start - The first frame of the clip
+	// 
+	// size_t count - The number of frames in the clip
+	// 
+	// float playSpeed - The number of seconds elapsed between frame changes
+	// 
+	// bool looping
+	int ( *addClip )( PrismAnimation*, string, size_t, size_t, float, bool );
+
+	// Add a clip playing an Animation's frames in a specific order
+	// 
+	// Works like addClip. The sequence is copied.
+	// 
+	// ----
+	// 
+	// PrismAnimation* animation
+	// 
+	// string name - Must be unique within the Animation, copied
+	// 
+	// size_t* sequence - Frame indexes, in the order they should be played. e.g.: { 0, 3, 1 }
+	// 
+	// size_t count - The length of the sequence array
+	// 
+	// float playSpeed - The number of seconds elapsed between frame changes
+	// 
+	// bool looping
+	int ( *addClipSequence )( PrismAnimation*, string, size_t*, size_t, float, bool );
+
+	// Look up a clip's id by name
+	// 
+	// Returns -1 if the Animation has no clip with that name.
+	// 
+	// ----
+	// 
+	// PrismAnimation* animation
+	// 
+	// string name
+	int ( *getClip )( PrismAnimation*, string );
+
+	// Switch to a clip, showing its first frame right away
+	// 
+	// The clip's playSpeed and looping replace the Animation's. Does nothing 
+	// if the clip is already playing and has not finished, so it can be 
+	// called every update. Never allocates.
+	// 
+	// ----
+	// 
+	// PrismAnimation* animation
+	// 
+	// int clip - A clip id returned by addClip, addClipSequence or getClip
+	void ( *playClip )( PrismAnimation*, int );
+
+	// Advance every Animation with autoPlay set, in one pass over the 
+	// Animation pool
+	// 
+	// Called by prismaticSceneManager->update, after the Scenes and 
+	// persistent Sprites have been updated. Only Animations whose Sprite was
+	// updated since the last tickAll, by a Scene that is not frozen or as a
+	// persistent Sprite, are advanced. Dormant Sprites are not updated. A 
+	// Sprite's image is only set when its frame changes.
+	// 
+	// ----
+	// 
+	// float delta - The time, in seconds, since the last update
+	void ( *tickAll )( float );
+
+	// Get the number of Sprite image changes made by Animations during the 
+	// last tickAll, counting those made by play and playClip since the 
+	// tickAll before it
+	size_t ( *imageSwaps )( void );
+
+	// Time each of an Animation's frames individually
+	// 
+	// Durations replace playSpeed for every frame, including in clips. The 
+	// array is copied. Pass NULL to go back to playSpeed.
+	// 
+	// ----
+	// 
+	// PrismAnimation* animation
+	// 
+	// float* durations - Seconds to show each frame, one for each of the 
+	// Animation's frames
+	void ( *setDurations )( PrismAnimation*, float* );
 } AnimationFn;
 
+typedef struct SpritePoolFn {
+	// Create a pool of Sprites sharing an array of LCDBitmap*s
+	// 
+	// All capacity Sprites, their LCDSprites and Animations are created 
+	// here, so acquiring and releasing them never allocates. Caller is 
+	// responsible for freeing frames with prismaticSprite->freeImages after 
+	// the pool is deleted.
+	// 
+	// ----
+	// 
+	// LCDBitmap** frames
+	// 
+	// size_t capacity - The number of Sprites in the pool
+	// 
+	// float playSpeed - The number of seconds elapsed between frame changes
+	PrismSpritePool* ( *new )( LCDBitmap**, size_t, float );
+
+	// Create a pool of Sprites sharing an image table, see 
+	// prismaticSprite->newFromTable
+	// 
+	// ----
+	// 
+	// string path - Path to the table, without the -table-W-H suffix or 
+	// extension. e.g. "assets/images/bullet"
+	// 
+	// size_t capacity - The number of Sprites in the pool
+	// 
+	// float playSpeed - The number of seconds elapsed between frame changes
+	PrismSpritePool* ( *newFromTable )( string, size_t, float );
+
+	// Take a Sprite from the pool
+	// 
+	// The Sprite is shown and added to the display list, and its Animation 
+	// is restarted and unpaused. Its id, update and ref are kept from its 
+	// last use, so they only need setting when they change. Each pooled 
+	// Sprite is given a unique id when the pool is created, add it to a Scene
+	// under that id, prismaticScene->add( scene, sprite->id, sprite ), to 
+	// keep acquiring and adding it free of allocations.
+	// 
+	// Returns NULL if every Sprite is already acquired.
+	// 
+	// ----
+	// 
+	// PrismSpritePool* pool
+	PrismSprite* ( *acquire )( PrismSpritePool* );
+
+	// Give a Sprite back to its pool
+	// 
+	// The Sprite is hidden, removed from the display list and its Animation 
+	// is paused, but its LCDSprite and Animation are kept for the next 
+	// acquire. Remove the Sprite from any Scene first.
+	// 
+	// ----
+	// 
+	// PrismSpritePool* pool
+	// 
+	// PrismSprite* sprite
+	void ( *release )( PrismSpritePool*, PrismSprite* );
+
+	// Get the number of Sprites that can still be acquired
+	// 
+	// ----
+	// 
+	// PrismSpritePool* pool
+	size_t ( *available )( PrismSpritePool* );
+
+	// Delete a pool and every Sprite in it that is not acquired
+	// 
+	// Pooled Sprites are never deleted by Scenes or prismaticSprite->delete,
+	// only by this. Sprites still acquired leave the pool instead and become
+	// ordinary Sprites, deleted by their Scenes or prismaticSprite->delete. 
+	// Keep the frames of a pool made with prismaticSpritePool->new until 
+	// those are deleted too.
+	// 
+	// ----
+	// 
+	// PrismSpritePool* pool
+	void ( *delete )( PrismSpritePool* );
+} SpritePoolFn;
+
 extern const SpriteFn* prismaticSprite;
 extern const AnimationFn* prismaticAnimation;
+extern const SpritePoolFn* prismaticSpritePool;
 
 #endif  // SPRITE_H
\ No newline at end of file
@@ -55,8 +55,7 @@ static void freeStates( StateMachine* stateMachine ) {
 
 	stateMachine->totalStates = 0;
 
-	sys->realloc( stateMachine->states, 0 );
-	stateMachine->states = NULL;
+	stateMachine->states = prismaticArray->release( stateMachine->states, &stateMachine->_stateCapacity );
 
 }
 
@@ -144,14 +143,15 @@ static void addState( StateMachine* stateMachine, State* state ) {
 		return;
 	}
 
-	stateMachine->totalStates += 1;
-	stateMachine->states = sys->realloc( stateMachine->states, stateMachine->totalStates * sizeof(State) + 1 );
+	State** states = prismaticArray->reserve( stateMachine->states, &stateMachine->_stateCapacity, stateMachine->totalStates + 2, sizeof( State* ) );
 
-	if (stateMachine->states == NULL) {
+	if (states == NULL) {
         prismaticLogger->error( "Memory allocation failed for adding state.\n" );
         return;
     }
     
+    stateMachine->states = states;
+    stateMachine->totalStates += 1;
     stateMachine->states[stateMachine->totalStates - 1] = state;
     stateMachine->states[stateMachine->totalStates] = NULL;
 
@@ -18,6 +18,7 @@ typedef struct State {
 typedef struct StateMachine {
 	State** states;
 	size_t totalStates;
+	size_t _stateCapacity;
 	State* defaultState;
 	State* previousState;
 	State* currentState;
@@ -1,10 +1,96 @@
 #include <stddef.h>
 #include <stdlib.h>
 #include <stdio.h>
+#include <string.h>
 
 #include "../prismatic.h"
 #include "ldtk.h"
 
+// "PLDK" read as a little endian uint32
+#define LDTK_BINARY_MAGIC 0x4B444C50
+#define LDTK_BINARY_VERSION 2
+
+// Bytes of a collision csv read at a time
+#define LDTK_CSV_BUFFER_SIZE 128
+
+// The JSON keys the decoder handles, see matchKey
+typedef enum {
+	LDtkKey_Unknown,
+	LDtkKey_X,
+	LDtkKey_Y,
+	LDtkKey_Id,
+	LDtkKey_Dir,
+	LDtkKey_Iid,
+	LDtkKey_Width,
+	LDtkKey_Layer,
+	LDtkKey_Height,
+	LDtkKey_Layers,
+	LDtkKey_BgColor,
+	LDtkKey_Entities,
+	LDtkKey_LevelIid,
+	LDtkKey_Identifier,
+	LDtkKey_CustomFields,
+	LDtkKey_UniqueIdentifer,
+	LDtkKey_NeighbourLevels,
+} LDtkKey;
+
+// The records of a binary map, see tools/ldtkcook.py. Strings are offsets
+// from the start of the file, 0 for NULL.
+typedef struct LDtkBinaryHeader {
+	uint32_t magic;
+	uint32_t version;
+	uint32_t id;
+	uint32_t iid;
+	int32_t worldX;
+	int32_t worldY;
+	int32_t width;
+	int32_t height;
+	uint32_t tileSize;
+	uint32_t gridWidth;
+	uint32_t gridHeight;
+	uint32_t layerCount;
+	uint32_t layers;
+	uint32_t neighborCount;
+	uint32_t neighbors;
+	uint32_t groupCount;
+	uint32_t groups;
+	uint32_t entityCount;
+	uint32_t entities;
+	uint32_t intGridCount;
+	uint32_t intGrids;
+} LDtkBinaryHeader;
+
+typedef struct LDtkBinaryLayer {
+	uint32_t filename;
+	int32_t zIndex;
+} LDtkBinaryLayer;
+
+typedef struct LDtkBinaryNeighbor {
+	uint32_t levelIid;
+	uint32_t dir;
+} LDtkBinaryNeighbor;
+
+typedef struct LDtkBinaryGroup {
+	uint32_t type;
+	uint32_t first;
+	uint32_t count;
+} LDtkBinaryGroup;
+
+typedef struct LDtkBinaryEntity {
+	uint32_t id;
+	uint32_t iid;
+	uint32_t layer;
+	int32_t x;
+	int32_t y;
+	int32_t width;
+	int32_t height;
+} LDtkBinaryEntity;
+
+typedef struct LDtkBinaryIntGrid {
+	uint32_t name;
+	uint32_t data;
+} LDtkBinaryIntGrid;
+
 static LDtkTileMap* newLDtkTileMap( string path, int tileSize, string* collisionLayers, LDtkFieldHandler* customFieldHandler );
 static void deleteLDtkTileMap( LDtkTileMap* map );
 static void drawLDtkTileMap( LDtkTileMap* map );
@@ -13,6 +99,30 @@ static void removeLDtkTileMap( LDtkTileMap* map );
 static void addCollisionLDtkTileMap( LDtkTileMap* map );
 static void removeCollisionLDtkTileMap( LDtkTileMap* map );
 static void tagCollisionLDtkTileMap( LDtkTileMap* map, string layerName, uint8_t tag );
+static void tagValuesLDtkTileMap( LDtkTileMap* map, string layerName, const LDtkCollisionTag* tags, size_t count );
+static LDtkCollisionLayer* getCollisionLDtkTileMap( LDtkTileMap* map, string layerName );
+static bool isSolidLDtkTileMap( LDtkTileMap* map, LDtkCollisionLayer* layer, int tx, int ty );
+static uint8_t getValueLDtkTileMap( LDtkTileMap* map, LDtkCollisionLayer* layer, int tx, int ty );
+static const uint32_t* getSolidRowLDtkTileMap( LDtkTileMap* map, LDtkCollisionLayer* layer, int ty );
+static void worldToTileLDtkTileMap( LDtkTileMap* map, float x, float y, int* tx, int* ty );
+
+static LDtkTileMap* newDeferredLDtkTileMap( string path, int tileSize, string* collisionLayers, LDtkFieldHandler* customFieldHandler );
+static LDtkLoadStage loadStepLDtkTileMap( LDtkTileMap* map );
+static LDtkTileMap* newBinaryLDtkTileMap( string path );
+
+static bool decodeMapJson( LDtkTileMap* map );
+static void loadLayerImage( LDtkTileMap* map, LDtkLayer* layer );
+static bool loadCollisionLayer( LDtkTileMap* map, string layerName );
+
+static bool validBinaryMap( const uint8_t* blob, size_t size );
+static bool binaryFits( size_t size, uint32_t offset, uint32_t count, size_t recordSize );
+static size_t binaryEnd( size_t end, uint32_t offset, uint32_t count, size_t recordSize );
+static bool binaryStringFits( size_t start, size_t size, uint32_t offset );
+static string binaryString( uint8_t* blob, uint32_t offset );
+static size_t alignBlock( size_t size );
+static void* carveBlock( uint8_t** cursor, size_t size );
+static bool buildBinaryMap( LDtkTileMap* map, uint8_t* blob, size_t size );
+static void freeBinaryMap( LDtkTileMap* map );
 
 static void freeMapCollisions( LDtkTileMap* map );
 static void freeMapRefs( LDtkTileMap* map );
@@ -31,10 +141,16 @@ static void changeMapByIid( LDtkMapManager* mapManager, string iid );
 static void changeMapByName( LDtkMapManager* mapManager, string id );
 static void changeMap( LDtkMapManager* mapManager, LDtkTileMap* map );
 
-static void parseCollision( string layerName, SDFile* file, LDtkTileMap* map );
-static void stripNewlines( string str );
-static void csvToCollision( string layerName, string rawCollisionData, LDtkTileMap* map );
+static bool parseCollision( string layerName, SDFile* file, LDtkTileMap* map );
+static void setCollisionValue( LDtkTileMap* map, LDtkCollisionLayer* collisionLayer, size_t tile, int value );
+static bool mergeCollisionRects( LDtkTileMap* map, LDtkCollisionLayer* collisionLayer, int value, uint8_t tag );
+static bool tileMatches( LDtkTileMap* map, LDtkCollisionLayer* collisionLayer, int value, int x, int y );
+static void freeCollisionRects( LDtkCollisionLayer* collisionLayer );
+static size_t solidRowWords( LDtkTileMap* map );
+static bool solidBit( const uint32_t* row, int x );
+static LCDSprite* newCollisionRect( LDtkTileMap* map, int x, int y, int width, int height );
 
+static LDtkKey matchKey( const char* key );
 static void decodeError( json_decoder* decoder, const char* error, int linenum );
 static void willDecodeSublist( json_decoder* decoder, const char* name, json_value_type type );
 static int shouldDecodeTableValueForKey( json_decoder* decoder, const char* key ) ;
@@ -58,127 +174,233 @@ static int readfile( void* readud, uint8_t* buf, int bufsize );
 
 static LDtkTileMap* newLDtkTileMap( string path, int tileSize, string* collisionLayers, LDtkFieldHandler* customFieldHandler ) {
 
-	const string dataFile = "/data.json";
-	string trimmedPath = prismaticString->trimLast( path, '/' );
+	LDtkTileMap* map = newDeferredLDtkTileMap( path, tileSize, collisionLayers, customFieldHandler );
+	if( map == NULL ) {
+		return NULL;
+	}
 
-	string dataPath = prismaticString->new( trimmedPath );
-	prismaticString->concat( &dataPath, dataFile );
+	LDtkLoadStage stage = map->_loadStage;
+	while( stage != LDtkLoadStage_Done && stage != LDtkLoadStage_Failed ) {
+		stage = loadStepLDtkTileMap( map );
+	}
 
-	LDtkTileMap* map = calloc( 1, sizeof( LDtkTileMap ) );
-	json_reader* mapReader = calloc( 1, sizeof( json_reader ) );
-	json_decoder* mapDecoder = calloc( 1, sizeof( json_decoder ) );
-	SDFile* jsonFile = pd->file->open( dataPath, kFileRead );
+	if( stage == LDtkLoadStage_Failed ) {
+		deleteLDtkTileMap( map );
+		return NULL;
+	}
 
-	if( jsonFile == NULL ) {
-		prismaticLogger->errorf( "Failed to open JSON at path \"%s\"", dataPath );
+	return map;
 
-		// Free allocated memory
-		prismaticString->delete( trimmedPath );
-		prismaticString->delete( dataPath );
-		
-		free( mapReader );
-		mapReader = NULL;
-		
-		free( mapDecoder );
-		mapDecoder = NULL;
-		
+}
+
+static LDtkTileMap* newDeferredLDtkTileMap( string path, int tileSize, string* collisionLayers, LDtkFieldHandler* customFieldHandler ) {
+
+	if( path == NULL || *path == '\0' ) {
+		prismaticLogger->error( "Cannot load TileMap from an empty path" );
 		return NULL;
 	}
 
-	map->_path = trimmedPath;
-	map->_layerCount = 0;
-	map->_neighborCount = 0;
+	LDtkTileMap* map = calloc( 1, sizeof( LDtkTileMap ) );
+	if( map == NULL ) {
+		prismaticLogger->error( "Could not allocate memory for new TileMap" );
+		return NULL;
+	}
+
+	map->_path = prismaticString->trimLast( path, '/' );
 	map->tileSize = tileSize;
+	map->_loadStage = LDtkLoadStage_Json;
+	map->_loadIndex = 0;
 
 	if( customFieldHandler != NULL ) {
 		map->_customFieldHandler = customFieldHandler;
 	}
-	
-	mapReader->read = readfile;
-	mapReader->userdata = jsonFile;
 
-	mapDecoder->decodeError = decodeError;
-	mapDecoder->shouldDecodeTableValueForKey = shouldDecodeTableValueForKey;
-	mapDecoder->didDecodeTableValue = didDecodeTableValue;
-	mapDecoder->willDecodeSublist = willDecodeSublist;
-	mapDecoder->shouldDecodeArrayValueAtIndex = shouldDecodeArrayValueAtIndex;
-	mapDecoder->didDecodeArrayValue = didDecodeArrayValue;
-	mapDecoder->didDecodeSublist = didDecodeSublist;
-	mapDecoder->userdata = map;
+	// Copy the list itself so the caller can free it before loading finishes.
+	// The layer names are kept as-is, they become the collision layer names.
+	if( collisionLayers != NULL ) {
 
-	pd->json->decode( mapDecoder, *mapReader, NULL );
+		size_t count = 0;
+		while( collisionLayers[count] != NULL ) {
+			count++;
+		}
 
-	map->gridWidth = map->width / map->tileSize;
-	map->gridHeight = map->height / map->tileSize;
+		map->_collisionLayers = sys->realloc( NULL, sizeof( string ) * ( count + 1 ) );
+		if( map->_collisionLayers == NULL ) {
+			prismaticLogger->error( "Could not allocate memory for collision layer names" );
+			deleteLDtkTileMap( map );
+			return NULL;
+		}
 
-	if( collisionLayers != NULL ) {
+		memcpy( map->_collisionLayers, collisionLayers, sizeof( string ) * ( count + 1 ) );
 
-		for( size_t i = 0; collisionLayers[i] != NULL; i++ ) {
+	}
 
-			if( prismaticString->equals( collisionLayers[i], "" ) ) {
-				continue;
+	return map;
+
+}
+
+static LDtkLoadStage loadStepLDtkTileMap( LDtkTileMap* map ) {
+
+	if( map == NULL ) {
+		return LDtkLoadStage_Failed;
+	}
+
+	switch( map->_loadStage ) {
+
+		case LDtkLoadStage_Json:
+
+			if( !decodeMapJson( map ) ) {
+				map->_loadStage = LDtkLoadStage_Failed;
+				break;
+			}
+
+			map->_loadStage = LDtkLoadStage_Layers;
+			map->_loadIndex = 0;
+			break;
+
+		case LDtkLoadStage_Layers:
+
+			if( map->layers != NULL && map->layers[map->_loadIndex] != NULL ) {
+				loadLayerImage( map, map->layers[map->_loadIndex] );
+				map->_loadIndex++;
+				break;
 			}
 
-			SDFile* collisionFile = NULL;
-			string collisionPath = prismaticString->new( trimmedPath );
-			prismaticString->concat( &collisionPath, "/" );
-			prismaticString->concat( &collisionPath, collisionLayers[i] );
-			prismaticString->concat( &collisionPath, ".csv" );
+			// Out of layers, move on to the collision in the same step
+			map->_loadStage = LDtkLoadStage_Collision;
+			map->_loadIndex = 0;
+			// fall through
+
+		case LDtkLoadStage_Collision:
+
+			if( map->_collisionLayers != NULL ) {
 
-			collisionFile = pd->file->open( collisionPath, kFileRead );
-			if( collisionFile == NULL ) {
-				prismaticLogger->errorf( "Failed to open collision csv at path \"%s\"", collisionPath );
+				// Skip over empty layer names
+				while( map->_collisionLayers[map->_loadIndex] != NULL && prismaticString->equals( map->_collisionLayers[map->_loadIndex], "" ) ) {
+					map->_loadIndex++;
+				}
+
+				string layerName = map->_collisionLayers[map->_loadIndex];
+				if( layerName != NULL ) {
 
-				// Free allocated memory
-				prismaticString->delete( trimmedPath );
-				prismaticString->delete( dataPath );
-				prismaticString->delete( collisionPath );
+					if( !loadCollisionLayer( map, layerName ) ) {
+						map->_loadStage = LDtkLoadStage_Failed;
+						break;
+					}
 
-				free( mapReader );
-				mapReader = NULL;
+					map->_loadIndex++;
+					break;
 
-				free( mapDecoder );
-				mapDecoder = NULL;
+				}
 
-				// Close Files
-				pd->file->close( jsonFile );
-				return NULL;
 			}
 
-			parseCollision( collisionLayers[i], collisionFile, map );
+			map->_collisionLayers = sys->realloc( map->_collisionLayers, 0 );
+			map->_collisionLayers = NULL;
+			map->_loadStage = LDtkLoadStage_Done;
+			break;
+
+		default:
+			break;
 
-			// free collisionPath
-			prismaticString->delete( collisionPath );
+	}
 
-			// Close collisionFile
-			pd->file->close( collisionFile );
+	return map->_loadStage;
 
-		}
+}
+
+static LDtkTileMap* newBinaryLDtkTileMap( string path ) {
 
+	if( path == NULL || *path == '\0' ) {
+		prismaticLogger->error( "Cannot load TileMap from an empty path" );
+		return NULL;
 	}
 
-	// Free allocated memory
-	prismaticString->delete( trimmedPath );
-	prismaticString->delete( dataPath );
-	
-	free( mapReader );
-	mapReader = NULL;
+	SDFile* file = pd->file->open( path, kFileRead );
+	if( file == NULL ) {
+		prismaticLogger->errorf( "Failed to open binary map at path \"%s\"", path );
+		return NULL;
+	}
 
-	free( mapDecoder );
-	mapDecoder = NULL;
+	int size = -1;
+	if( pd->file->seek( file, 0, SEEK_END ) != -1 ) {
+		size = pd->file->tell( file );
+	}
+
+	if( size < (int)sizeof( LDtkBinaryHeader ) || pd->file->seek( file, 0, SEEK_SET ) == -1 ) {
+		prismaticLogger->errorf( "Could not determine the size of binary map \"%s\"", path );
+		pd->file->close( file );
+		return NULL;
+	}
+
+	uint8_t* blob = sys->realloc( NULL, size );
+	if( blob == NULL ) {
+		prismaticLogger->error( "Could not allocate memory for binary map" );
+		pd->file->close( file );
+		return NULL;
+	}
+
+	int readSize = pd->file->read( file, blob, size );
+	pd->file->close( file );
+
+	if( readSize != size || !validBinaryMap( blob, size ) ) {
+		prismaticLogger->errorf( "Binary map \"%s\" could not be read, cook it again with tools/ldtkcook.py", path );
+		sys->realloc( blob, 0 );
+		return NULL;
+	}
+
+	LDtkTileMap* map = calloc( 1, sizeof( LDtkTileMap ) );
+	if( map == NULL ) {
+		prismaticLogger->error( "Could not allocate memory for new TileMap" );
+		sys->realloc( blob, 0 );
+		return NULL;
+	}
+
+	// Layer images sit next to the binary
+	map->_path = prismaticString->new( path );
+	string slash = strrchr( map->_path, '/' );
+	if( slash != NULL ) {
+		*slash = '\0';
+	} else {
+		prismaticString->delete( map->_path );
+		map->_path = prismaticString->new( "." );
+	}
+
+	if( !buildBinaryMap( map, blob, size ) ) {
+		prismaticString->delete( map->_path );
+		free( map );
+		return NULL;
+	}
+
+	for( size_t i = 0; map->layers[i] != NULL; i++ ) {
+		loadLayerImage( map, map->layers[i] );
+	}
+
+	map->_loadStage = LDtkLoadStage_Done;
 
-	// Close Files
-	pd->file->close( jsonFile );
-	
 	return map;
 
 }
 
 static void deleteLDtkTileMap( LDtkTileMap* map ) {
 
+	// Everything but the path lives in the binary
+	if( map->_blob != NULL ) {
+		prismaticString->delete( map->_path );
+		freeBinaryMap( map );
+		free( map );
+		return;
+	}
+
 	// Since our strings are duplicated, we need to explicitly free them
 	prismaticString->delete( map->id );
 	prismaticString->delete( map->iid );
+	prismaticString->delete( map->_path );
+
+	if( map->_collisionLayers != NULL ) {
+		sys->realloc( map->_collisionLayers, 0 );
+		map->_collisionLayers = NULL;
+	}
 
 	freeMapCollisions( map );
 	freeMapRefs( map );
@@ -208,13 +430,15 @@ static void addLDtkTileMap( LDtkTileMap* map ) {
 	if( map->_layerSprites == NULL ) {
 
 	    for( size_t i = 0; map->layers[i] != NULL; i++ ) {
-			map->_layerSpriteCount++;
-			map->_layerSprites = sys->realloc( map->_layerSprites, sizeof( LCDSprite* ) * map->_layerSpriteCount + 1 );
-			if( map->_layerSprites == NULL ) {
+			LCDSprite** layerSprites = prismaticArray->reserve( map->_layerSprites, &map->_layerSpriteCapacity, map->_layerSpriteCount + 2, sizeof( LCDSprite* ) );
+			if( layerSprites == NULL ) {
 				prismaticLogger->error( "Could not allocate memory for layer sprites" );
 				return;
 			}
 
+			map->_layerSprites = layerSprites;
+			map->_layerSpriteCount++;
+
 			LDtkLayer* layer = map->layers[i];
 			LCDSprite* sprite = sprites->newSprite();
 			sprites->setCenter( sprite, 0.0, 0.0 );
@@ -252,6 +476,8 @@ static void removeLDtkTileMap( LDtkTileMap* map ) {
 
 static void addCollisionLDtkTileMap( LDtkTileMap* map ) {
 
+	map->_collisionAdded = true;
+
 	if( map->collision == NULL ) {
 		return;
 	}
@@ -270,6 +496,8 @@ static void addCollisionLDtkTileMap( LDtkTileMap* map ) {
 
 static void removeCollisionLDtkTileMap( LDtkTileMap* map ) {
    
+	map->_collisionAdded = false;
+
 	if( map->collision == NULL ) {
 		return;
 	}
@@ -298,7 +526,7 @@ static void tagCollisionLDtkTileMap( LDtkTileMap* map, string layerName, uint8_t
 
 	for( size_t i = 0; map->collision[i] != NULL; i++ ) {
 
-		if( map->collision[i]->name != layerName ) {
+		if( !prismaticString->equals( map->collision[i]->name, layerName ) ) {
 			continue;
 		}
 
@@ -314,6 +542,128 @@ static void tagCollisionLDtkTileMap( LDtkTileMap* map, string layerName, uint8_t
 
 }
 
+static void tagValuesLDtkTileMap( LDtkTileMap* map, string layerName, const LDtkCollisionTag* tags, size_t count ) {
+
+	LDtkCollisionLayer* collisionLayer = getCollisionLDtkTileMap( map, layerName );
+	if( collisionLayer == NULL ) {
+		prismaticLogger->errorf( "Map has no collision layer named \"%s\" to tag", layerName != NULL ? layerName : "" );
+		return;
+	}
+
+	freeCollisionRects( collisionLayer );
+
+	// Only the values in the table are solid from now on
+	size_t rowWords = solidRowWords( map );
+	memset( collisionLayer->solid, 0, sizeof( uint32_t ) * rowWords * map->gridHeight );
+
+	for( int y = 0; y < map->gridHeight; y++ ) {
+		for( int x = 0; x < map->gridWidth; x++ ) {
+
+			uint8_t value = collisionLayer->values[y * map->gridWidth + x];
+
+			for( size_t i = 0; i < count; i++ ) {
+				if( tags[i].value == value ) {
+					collisionLayer->solid[y * rowWords + x / 32] |= (uint32_t)1 << ( x % 32 );
+					break;
+				}
+			}
+
+		}
+	}
+
+	for( size_t i = 0; i < count; i++ ) {
+
+		// A value listed twice would get a second set of rects
+		size_t first = 0;
+		while( tags[first].value != tags[i].value ) {
+			first++;
+		}
+
+		if( first < i ) {
+			continue;
+		}
+
+		if( !mergeCollisionRects( map, collisionLayer, tags[i].value, tags[i].tag ) ) {
+			break;
+		}
+
+	}
+
+	// freeCollisionRects took the old rects off the display list
+	if( map->_collisionAdded && collisionLayer->rects != NULL ) {
+		for( size_t i = 0; collisionLayer->rects[i] != NULL; i++ ) {
+			sprites->addSprite( collisionLayer->rects[i] );
+		}
+	}
+
+}
+
+static LDtkCollisionLayer* getCollisionLDtkTileMap( LDtkTileMap* map, string layerName ) {
+
+	if( map->collision == NULL || layerName == NULL ) {
+		return NULL;
+	}
+
+	for( size_t i = 0; map->collision[i] != NULL; i++ ) {
+		if( prismaticString->equals( map->collision[i]->name, layerName ) ) {
+			return map->collision[i];
+		}
+	}
+
+	return NULL;
+
+}
+
+static bool isSolidLDtkTileMap( LDtkTileMap* map, LDtkCollisionLayer* layer, int tx, int ty ) {
+
+	if( layer == NULL || tx < 0 || ty < 0 || tx >= map->gridWidth || ty >= map->gridHeight ) {
+		return false;
+	}
+
+	return solidBit( layer->solid + ty * solidRowWords( map ), tx );
+
+}
+
+static uint8_t getValueLDtkTileMap( LDtkTileMap* map, LDtkCollisionLayer* layer, int tx, int ty ) {
+
+	if( layer == NULL || tx < 0 || ty < 0 || tx >= map->gridWidth || ty >= map->gridHeight ) {
+		return 0;
+	}
+
+	return layer->values[ty * map->gridWidth + tx];
+
+}
+
+static const uint32_t* getSolidRowLDtkTileMap( LDtkTileMap* map, LDtkCollisionLayer* layer, int ty ) {
+
+	if( layer == NULL || ty < 0 || ty >= map->gridHeight ) {
+		return NULL;
+	}
+
+	return layer->solid + ty * solidRowWords( map );
+
+}
+
+static void worldToTileLDtkTileMap( LDtkTileMap* map, float x, float y, int* tx, int* ty ) {
+
+	float fx = ( x - (float)map->worldX ) / (float)map->tileSize;
+	float fy = ( y - (float)map->worldY ) / (float)map->tileSize;
+
+	// Round towards negative infinity so tiles left of and above the map 
+	// are out of range too
+	int ix = (int)fx;
+	int iy = (int)fy;
+
+	if( tx != NULL ) {
+		*tx = (float)ix > fx ? ix - 1 : ix;
+	}
+
+	if( ty != NULL ) {
+		*ty = (float)iy > fy ? iy - 1 : iy;
+	}
+
+}
+
 static void freeMapCollisions( LDtkTileMap* map ) {
 
 	if( map->collision == NULL ) {
@@ -322,30 +672,19 @@ static void freeMapCollisions( LDtkTileMap* map ) {
 
 	for( size_t i = 0; map->collision[i] != NULL; i++ ) {
 
-		for( int j = 0; j < map->gridWidth; j++ ) {
-			sys->realloc( map->collision[i]->collision[j], 0 );
-			map->collision[i]->collision[j] = NULL;
-		}
-		
-		if( map->collision[i]->rects != NULL ) {
-			for( size_t k = 0; map->collision[i]->rects[k] != NULL; k++ ) {
-				sprites->freeSprite( map->collision[i]->rects[k] );
-			}
-		}
-		
-		map->collision[i]->rects = sys->realloc( map->collision[i]->rects, 0 );
-		map->collision[i]->rects = NULL;
+		freeCollisionRects( map->collision[i] );
 
-		map->collision[i]->collision = sys->realloc( map->collision[i]->collision, 0 );
-		map->collision[i]->collision = NULL;
+		// The values share the solid bits' allocation
+		map->collision[i]->solid = sys->realloc( map->collision[i]->solid, 0 );
+		map->collision[i]->solid = NULL;
+		map->collision[i]->values = NULL;
 
 		free( map->collision[i] );
 		map->collision[i] = NULL;
 
 	}
 	
-	map->collision = sys->realloc( map->collision, 0 );
-	map->collision = NULL;
+	map->collision = prismaticArray->release( map->collision, &map->_collisionLayerCapacity );
 	map->_collisionLayerCount = 0;
 	
 }
@@ -364,8 +703,7 @@ static void freeMapRefs( LDtkTileMap* map ) {
 		map->neighborLevels[i] = NULL;
 	}
 
-	sys->realloc( map->neighborLevels, 0 );
-	map->neighborLevels = NULL;
+	map->neighborLevels = prismaticArray->release( map->neighborLevels, &map->_neighborCapacity );
 	map->_neighborCount = 0;
 
 }
@@ -381,8 +719,7 @@ static void freeMapLayers( LDtkTileMap* map ) {
 		map->layers[i] = NULL;
 	}
 
-	map->layers = sys->realloc( map->layers, 0 );
-	map->layers = NULL;
+	map->layers = prismaticArray->release( map->layers, &map->_layerCapacity );
 	map->_layerCount = 0;
 
 	if( map->_layerSprites != NULL ) {
@@ -391,8 +728,7 @@ static void freeMapLayers( LDtkTileMap* map ) {
 			sprites->freeSprite( map->_layerSprites[i] );
 		}
 
-		sys->realloc( map->_layerSprites, 0 );
-		map->_layerSprites = NULL;
+		map->_layerSprites = prismaticArray->release( map->_layerSprites, &map->_layerSpriteCapacity );
 		map->_layerSpriteCount = 0;
 
 	}
@@ -417,16 +753,14 @@ static void freeMapEntities( LDtkTileMap* map ) {
 			map->entities[i]->entities[j] = NULL;
 		}
 
-		map->entities[i]->entities = sys->realloc( map->entities[i]->entities, 0 );
-		map->entities[i]->entities = NULL;
+		map->entities[i]->entities = prismaticArray->release( map->entities[i]->entities, &map->entities[i]->_entityCapacity );
 		map->entities[i]->_entityCount = 0;
 
 		freeEntityGroup( map->entities[i] );
 
 	}
 
-	map->entities = sys->realloc( map->entities, 0 );
-	map->entities = NULL;
+	map->entities = prismaticArray->release( map->entities, &map->_entityGroupCapacity );
 	map->_entityGroupCount = 0;
 
 }
@@ -445,187 +779,790 @@ static void freeEntityGroup( LDtkEntityGroup* entityGroup ) {
 
 }
 
-// Collisions
+// Loading
 
-static void parseCollision( string layerName, SDFile* file, LDtkTileMap* map ) {
+static bool decodeMapJson( LDtkTileMap* map ) {
 
-	if( file == NULL || map == NULL ) {
-		return;
+	string dataPath = prismaticString->new( map->_path );
+	prismaticString->concat( &dataPath, "/data.json" );
+
+	SDFile* jsonFile = pd->file->open( dataPath, kFileRead );
+	if( jsonFile == NULL ) {
+		prismaticLogger->errorf( "Failed to open JSON at path \"%s\"", dataPath );
+		prismaticString->delete( dataPath );
+		return false;
 	}
 
-	int seekEndErr = pd->file->seek( file, 0, SEEK_END );
-	if( seekEndErr == -1 ) {
-		prismaticLogger->error( "Could not seek EOF for collision file" );
-		return;
+	json_reader mapReader = {
+		.read = readfile,
+		.userdata = jsonFile,
+	};
+
+	json_decoder mapDecoder = {
+		.decodeError = decodeError,
+		.shouldDecodeTableValueForKey = shouldDecodeTableValueForKey,
+		.didDecodeTableValue = didDecodeTableValue,
+		.willDecodeSublist = willDecodeSublist,
+		.shouldDecodeArrayValueAtIndex = shouldDecodeArrayValueAtIndex,
+		.didDecodeArrayValue = didDecodeArrayValue,
+		.didDecodeSublist = didDecodeSublist,
+		.userdata = map,
+	};
+
+	pd->json->decode( &mapDecoder, mapReader, NULL );
+
+	map->gridWidth = map->width / map->tileSize;
+	map->gridHeight = map->height / map->tileSize;
+
+	pd->file->close( jsonFile );
+	prismaticString->delete( dataPath );
+
+	return true;
+
+}
+
+static void loadLayerImage( LDtkTileMap* map, LDtkLayer* layer ) {
+
+	string layerPath = prismaticString->new( map->_path );
+	prismaticString->concat( &layerPath, "/" );
+	prismaticString->concat( &layerPath, layer->filename );
+
+	const char* err = NULL;
+	layer->image = prismaticAssets->loadBitmap( layerPath, &err );
+
+	if( err != NULL ) {
+		prismaticLogger->errorf( "%s", err );
 	}
 
-	int fsize = pd->file->tell( file );
-	if( fsize == -1 ) {
-		prismaticLogger->error( "Could not determine file size for collision file" );
-		return;
+	if( layer->image == NULL ) {
+		prismaticLogger->errorf( "Layer image at %s could not be loaded!", layerPath );
 	}
 
-	int seekSetErr = pd->file->seek( file, 0, SEEK_SET );
-	if( seekSetErr == -1 ) {
-		prismaticLogger->error( "Could not reset seek pointer in collision file" );
-		return;
+	prismaticString->delete( layerPath );
+
+}
+
+static bool loadCollisionLayer( LDtkTileMap* map, string layerName ) {
+
+	string collisionPath = prismaticString->new( map->_path );
+	prismaticString->concat( &collisionPath, "/" );
+	prismaticString->concat( &collisionPath, layerName );
+	prismaticString->concat( &collisionPath, ".csv" );
+
+	SDFile* collisionFile = pd->file->open( collisionPath, kFileRead );
+	if( collisionFile == NULL ) {
+		prismaticLogger->errorf( "Failed to open collision csv at path \"%s\"", collisionPath );
+		prismaticString->delete( collisionPath );
+		return false;
 	}
 
-	string rawCollisionData = sys->realloc( NULL, fsize + 1 );
-	if( rawCollisionData == NULL ) {
-		prismaticLogger->error( "Could not allocate memory for collision data" );
-		return;
+	bool parsed = parseCollision( layerName, collisionFile, map );
+
+	prismaticString->delete( collisionPath );
+	pd->file->close( collisionFile );
+
+	return parsed;
+
+}
+
+// Binary Maps
+
+static bool validBinaryMap( const uint8_t* blob, size_t size ) {
+
+	const LDtkBinaryHeader* header = (const LDtkBinaryHeader*)blob;
+
+	if( header->magic != LDTK_BINARY_MAGIC || header->version != LDTK_BINARY_VERSION ) {
+		prismaticLogger->error( "Binary map has the wrong magic or version" );
+		return false;
 	}
 
-	int readErr = pd->file->read( file, rawCollisionData, fsize );	
-	if( readErr == -1 ) {
-		prismaticLogger->error( "Could not read collision file" );
-		sys->realloc( rawCollisionData, 0 );
-		return;
+	// Every string ends before the file does
+	if( blob[size - 1] != '\0' ) {
+		return false;
+	}
+
+	if( header->tileSize == 0 || header->gridWidth > INT16_MAX || header->gridHeight > INT16_MAX ) {
+		return false;
+	}
+
+	size_t rowSize = sizeof( uint32_t ) * ( ( header->gridWidth + 31 ) / 32 );
+
+	if( 
+		!binaryFits( size, header->layers, header->layerCount, sizeof( LDtkBinaryLayer ) )
+		|| !binaryFits( size, header->neighbors, header->neighborCount, sizeof( LDtkBinaryNeighbor ) )
+		|| !binaryFits( size, header->groups, header->groupCount, sizeof( LDtkBinaryGroup ) )
+		|| !binaryFits( size, header->entities, header->entityCount, sizeof( LDtkBinaryEntity ) )
+		|| !binaryFits( size, header->intGrids, header->intGridCount, sizeof( LDtkBinaryIntGrid ) )
+	) {
+		return false;
+	}
+
+	// Groups cover the entities back to back, each entity in exactly one,
+	// which is what buildBinaryMap sizes the entity lists for
+	const LDtkBinaryGroup* groups = (const LDtkBinaryGroup*)( blob + header->groups );
+	uint32_t grouped = 0;
+	for( uint32_t i = 0; i < header->groupCount; i++ ) {
+
+		if( groups[i].first != grouped || groups[i].count > header->entityCount - grouped ) {
+			return false;
+		}
+
+		grouped += groups[i].count;
+
+	}
+
+	if( grouped != header->entityCount ) {
+		return false;
+	}
+
+	size_t gridSize = rowSize * header->gridHeight + header->gridWidth * header->gridHeight;
+
+	const LDtkBinaryIntGrid* intGrids = (const LDtkBinaryIntGrid*)( blob + header->intGrids );
+	for( uint32_t i = 0; i < header->intGridCount; i++ ) {
+		if( !binaryFits( size, intGrids[i].data, 1, gridSize ) ) {
+			return false;
+		}
+	}
+
+	// The strings follow every record and grid, so no string may point into 
+	// them or past the end of the file
+	size_t strings = sizeof( LDtkBinaryHeader );
+	strings = binaryEnd( strings, header->layers, header->layerCount, sizeof( LDtkBinaryLayer ) );
+	strings = binaryEnd( strings, header->neighbors, header->neighborCount, sizeof( LDtkBinaryNeighbor ) );
+	strings = binaryEnd( strings, header->groups, header->groupCount, sizeof( LDtkBinaryGroup ) );
+	strings = binaryEnd( strings, header->entities, header->entityCount, sizeof( LDtkBinaryEntity ) );
+	strings = binaryEnd( strings, header->intGrids, header->intGridCount, sizeof( LDtkBinaryIntGrid ) );
+
+	for( uint32_t i = 0; i < header->intGridCount; i++ ) {
+		strings = binaryEnd( strings, intGrids[i].data, 1, gridSize );
+	}
+
+	if( !binaryStringFits( strings, size, header->id ) || !binaryStringFits( strings, size, header->iid ) ) {
+		return false;
+	}
+
+	const LDtkBinaryLayer* layers = (const LDtkBinaryLayer*)( blob + header->layers );
+	for( uint32_t i = 0; i < header->layerCount; i++ ) {
+		if( !binaryStringFits( strings, size, layers[i].filename ) ) {
+			return false;
+		}
+	}
+
+	const LDtkBinaryNeighbor* neighbors = (const LDtkBinaryNeighbor*)( blob + header->neighbors );
+	for( uint32_t i = 0; i < header->neighborCount; i++ ) {
+		if( !binaryStringFits( strings, size, neighbors[i].levelIid ) || !binaryStringFits( strings, size, neighbors[i].dir ) ) {
+			return false;
+		}
+	}
+
+	for( uint32_t i = 0; i < header->groupCount; i++ ) {
+		if( !binaryStringFits( strings, size, groups[i].type ) ) {
+			return false;
+		}
+	}
+
+	const LDtkBinaryEntity* entities = (const LDtkBinaryEntity*)( blob + header->entities );
+	for( uint32_t i = 0; i < header->entityCount; i++ ) {
+		if( 
+			!binaryStringFits( strings, size, entities[i].id )
+			|| !binaryStringFits( strings, size, entities[i].iid )
+			|| !binaryStringFits( strings, size, entities[i].layer )
+		) {
+			return false;
+		}
 	}
 
-	stripNewlines( rawCollisionData );
-	csvToCollision( layerName, rawCollisionData, map );
+	for( uint32_t i = 0; i < header->intGridCount; i++ ) {
+		if( !binaryStringFits( strings, size, intGrids[i].name ) ) {
+			return false;
+		}
+	}
 
-	sys->realloc( rawCollisionData, 0 );
+	return true;
 
 }
 
-static void stripNewlines( string str ) {
+// Whether count records of recordSize starting at offset are inside the file,
+// records are read in place so they must also be aligned
+static bool binaryFits( size_t size, uint32_t offset, uint32_t count, size_t recordSize ) {
 
-    string src = str;
-    string dst = str;
-    
-    while( *src ) {
-        if( *src != '\n' && *src != '\r' ) {
-            *dst++ = *src;
-        }
+	if( offset % sizeof( uint32_t ) != 0 || offset > size ) {
+		return false;
+	}
 
-        src++;
-    }
-    
-    *dst = '\0';
+	if( recordSize == 0 ) {
+		return true;
+	}
+
+	return count <= ( size - offset ) / recordSize;
 
 }
 
-static void csvToCollision( string layerName, string rawCollisionData, LDtkTileMap* map ) {
-	
-	// Memory allocation
+// The larger of end and the end of count records of recordSize at offset, 
+// which binaryFits has already checked
+static size_t binaryEnd( size_t end, uint32_t offset, uint32_t count, size_t recordSize ) {
+
+	size_t recordsEnd = offset + count * recordSize;
+
+	return recordsEnd > end ? recordsEnd : end;
+
+}
+
+// Whether a string offset is NULL or inside the string table. The file ends 
+// with a NUL, so any string inside it is terminated.
+static bool binaryStringFits( size_t start, size_t size, uint32_t offset ) {
+	return offset == 0 || ( offset >= start && offset < size );
+}
+
+static string binaryString( uint8_t* blob, uint32_t offset ) {
+	return offset == 0 ? NULL : (string)( blob + offset );
+}
+
+static size_t alignBlock( size_t size ) {
+	return ( size + sizeof( void* ) - 1 ) & ~( sizeof( void* ) - 1 );
+}
+
+// Hand out the next size bytes of the binary's tail
+static void* carveBlock( uint8_t** cursor, size_t size ) {
+
+	void* block = *cursor;
+	*cursor += alignBlock( size );
+
+	return block;
+
+}
+
+// Build the map's structs in a tail grown onto the end of the binary, so the
+// whole map but its collision Sprites is one allocation. Frees the binary on 
+// failure.
+static bool buildBinaryMap( LDtkTileMap* map, uint8_t* blob, size_t size ) {
+
+	const LDtkBinaryHeader* header = (const LDtkBinaryHeader*)blob;
+
+	map->worldX = header->worldX;
+	map->worldY = header->worldY;
+	map->width = header->width;
+	map->height = header->height;
+	map->tileSize = (int)header->tileSize;
+	map->gridWidth = (int)header->gridWidth;
+	map->gridHeight = (int)header->gridHeight;
+	map->_layerCount = header->layerCount;
+	map->_neighborCount = header->neighborCount;
+	map->_entityGroupCount = header->groupCount;
+	map->_collisionLayerCount = header->intGridCount;
+
+	size_t solidSize = sizeof( uint32_t ) * solidRowWords( map ) * map->gridHeight;
+	const LDtkBinaryIntGrid* intGrids = (const LDtkBinaryIntGrid*)( blob + header->intGrids );
+
+	size_t tailSize = alignBlock( sizeof( LDtkLayer ) * header->layerCount )
+		+ alignBlock( sizeof( LDtkLayer* ) * ( header->layerCount + 1 ) )
+		+ alignBlock( sizeof( LDtkTileMapRef ) * header->neighborCount )
+		+ alignBlock( sizeof( LDtkTileMapRef* ) * ( header->neighborCount + 1 ) )
+		+ alignBlock( sizeof( LDtkEntityGroup ) * header->groupCount )
+		+ alignBlock( sizeof( LDtkEntityGroup* ) * ( header->groupCount + 1 ) )
+		+ alignBlock( sizeof( LDtkEntity ) * header->entityCount )
+		+ alignBlock( sizeof( LDtkEntity* ) * ( header->entityCount + header->groupCount ) )
+		+ alignBlock( sizeof( LDtkCollisionLayer ) * header->intGridCount )
+		+ alignBlock( sizeof( LDtkCollisionLayer* ) * ( header->intGridCount + 1 ) );
+
+
+	uint8_t* grown = sys->realloc( blob, alignBlock( size ) + tailSize );
+	if( grown == NULL ) {
+		prismaticLogger->error( "Could not allocate memory for binary map" );
+		sys->realloc( blob, 0 );
+		return false;
+	}
+
+	blob = grown;
+	header = (const LDtkBinaryHeader*)blob;
+	intGrids = (const LDtkBinaryIntGrid*)( blob + header->intGrids );
+
+	map->_blob = blob;
+	map->id = binaryString( blob, header->id );
+	map->iid = binaryString( blob, header->iid );
+
+	uint8_t* cursor = blob + alignBlock( size );
+
+	// Layers
+	const LDtkBinaryLayer* layerRecords = (const LDtkBinaryLayer*)( blob + header->layers );
+	LDtkLayer* layers = carveBlock( &cursor, sizeof( LDtkLayer ) * header->layerCount );
+	map->layers = carveBlock( &cursor, sizeof( LDtkLayer* ) * ( header->layerCount + 1 ) );
+
+	for( uint32_t i = 0; i < header->layerCount; i++ ) {
+		layers[i] = (LDtkLayer){
+			.filename = binaryString( blob, layerRecords[i].filename ),
+			.zIndex = layerRecords[i].zIndex,
+		};
+		map->layers[i] = &layers[i];
+	}
+
+	map->layers[header->layerCount] = NULL;
+
+	// Neighbors
+	const LDtkBinaryNeighbor* neighborRecords = (const LDtkBinaryNeighbor*)( blob + header->neighbors );
+	LDtkTileMapRef* neighbors = carveBlock( &cursor, sizeof( LDtkTileMapRef ) * header->neighborCount );
+	map->neighborLevels = carveBlock( &cursor, sizeof( LDtkTileMapRef* ) * ( header->neighborCount + 1 ) );
+
+	for( uint32_t i = 0; i < header->neighborCount; i++ ) {
+		neighbors[i] = (LDtkTileMapRef){
+			.levelIid = binaryString( blob, neighborRecords[i].levelIid ),
+			.dir = binaryString( blob, neighborRecords[i].dir ),
+		};
+		map->neighborLevels[i] = &neighbors[i];
+	}
+
+	map->neighborLevels[header->neighborCount] = NULL;
+
+	// Entities, each group's list is NULL terminated
+	const LDtkBinaryGroup* groupRecords = (const LDtkBinaryGroup*)( blob + header->groups );
+	const LDtkBinaryEntity* entityRecords = (const LDtkBinaryEntity*)( blob + header->entities );
+	LDtkEntityGroup* groups = carveBlock( &cursor, sizeof( LDtkEntityGroup ) * header->groupCount );
+	map->entities = carveBlock( &cursor, sizeof( LDtkEntityGroup* ) * ( header->groupCount + 1 ) );
+	LDtkEntity* entities = carveBlock( &cursor, sizeof( LDtkEntity ) * header->entityCount );
+	LDtkEntity** entityLists = carveBlock( &cursor, sizeof( LDtkEntity* ) * ( header->entityCount + header->groupCount ) );
+
+	for( uint32_t i = 0; i < header->groupCount; i++ ) {
+
+		groups[i] = (LDtkEntityGroup){
+			.type = binaryString( blob, groupRecords[i].type ),
+			._entityCount = groupRecords[i].count,
+			.entities = entityLists,
+		};
+
+		for( uint32_t j = 0; j < groupRecords[i].count; j++ ) {
+
+			const LDtkBinaryEntity* record = &entityRecords[groupRecords[i].first + j];
+			LDtkEntity* entity = &entities[groupRecords[i].first + j];
+
+			*entity = (LDtkEntity){
+				.id = binaryString( blob, record->id ),
+				.iid = binaryString( blob, record->iid ),
+				.layer = binaryString( blob, record->layer ),
+				.x = record->x,
+				.y = record->y,
+				.width = record->width,
+				.height = record->height,
+			};
+
+			*entityLists++ = entity;
+
+		}
+
+		*entityLists++ = NULL;
+		map->entities[i] = &groups[i];
+
+	}
+
+	map->entities[header->groupCount] = NULL;
+
+	// Collision
+	LDtkCollisionLayer* collisionLayers = carveBlock( &cursor, sizeof( LDtkCollisionLayer ) * header->intGridCount );
+	map->collision = carveBlock( &cursor, sizeof( LDtkCollisionLayer* ) * ( header->intGridCount + 1 ) );
+
+	for( uint32_t i = 0; i < header->intGridCount; i++ ) {
+
+		LDtkCollisionLayer* collisionLayer = &collisionLayers[i];
+
+		// The cooked solid bits are followed by the values
+		*collisionLayer = (LDtkCollisionLayer){
+			.name = binaryString( blob, intGrids[i].name ),
+			.solid = (uint32_t*)( blob + intGrids[i].data ),
+			.values = blob + intGrids[i].data + solidSize,
+		};
+
+		// The rects are the only part of the map outside the binary
+		if( !mergeCollisionRects( map, collisionLayer, -1, 0 ) ) {
+
+			prismaticLogger->errorf( "Could not build collision rects for layer \"%s\"", collisionLayer->name );
+
+			for( uint32_t j = 0; j <= i; j++ ) {
+				freeCollisionRects( &collisionLayers[j] );
+			}
+
+			sys->realloc( blob, 0 );
+			map->_blob = NULL;
+			return false;
+
+		}
+
+		map->collision[i] = collisionLayer;
+
+	}
+
+	map->collision[header->intGridCount] = NULL;
+
+	return true;
+
+}
+
+static void freeBinaryMap( LDtkTileMap* map ) {
+
+	for( size_t i = 0; map->layers[i] != NULL; i++ ) {
+		if( map->layers[i]->image != NULL ) {
+			prismaticAssets->release( map->layers[i]->image );
+		}
+	}
+
+	if( map->_layerSprites != NULL ) {
+
+		for( size_t i = 0; map->_layerSprites[i] != NULL; i++ ) {
+			sprites->freeSprite( map->_layerSprites[i] );
+		}
+
+		map->_layerSprites = prismaticArray->release( map->_layerSprites, &map->_layerSpriteCapacity );
+		map->_layerSpriteCount = 0;
+
+	}
+
+	for( size_t i = 0; map->collision[i] != NULL; i++ ) {
+		freeCollisionRects( map->collision[i] );
+	}
+
+	map->_blob = sys->realloc( map->_blob, 0 );
+	map->_blob = NULL;
+
+}
+
+// Collisions
+
+// Read a collision csv a buffer at a time into a new collision layer. Values
+// end at a comma or a line ending, anything else but digits is skipped, so 
+// values may have any number of digits and lines may end in CRLF.
+static bool parseCollision( string layerName, SDFile* file, LDtkTileMap* map ) {
+
+	if( file == NULL || map == NULL ) {
+		return false;
+	}
+
 	LDtkCollisionLayer* collisionLayer = calloc( 1, sizeof( LDtkCollisionLayer ) );
 	if( collisionLayer == NULL ) {
 		prismaticLogger->error( "Could not allocate collision layer memory" );
-		return;
+		return false;
 	}
 
 	collisionLayer->name = layerName;
 
-	map->_collisionLayerCount += 1;
-	map->collision = sys->realloc( map->collision, sizeof( LDtkCollisionLayer* ) * map->_collisionLayerCount + 1 );
+	LDtkCollisionLayer** collision = prismaticArray->reserve( map->collision, &map->_collisionLayerCapacity, map->_collisionLayerCount + 2, sizeof( LDtkCollisionLayer* ) );
+	if( collision == NULL ) {
+		prismaticLogger->error( "Could not allocate memory for collision layers" );
+		free( collisionLayer );
+		return false;
+	}
+
+	map->collision = collision;
 
-	collisionLayer->collision = sys->realloc( NULL, sizeof( int* ) * map->gridWidth );
-	if( collisionLayer->collision == NULL ) {
+	// One allocation, the solid bits first so they stay aligned
+	size_t solidSize = sizeof( uint32_t ) * solidRowWords( map ) * map->gridHeight;
+	size_t tiles = (size_t)map->gridWidth * map->gridHeight;
+
+	collisionLayer->solid = sys->realloc( NULL, solidSize + tiles + 1 );
+	if( collisionLayer->solid == NULL ) {
 		prismaticLogger->error( "Could not allocate memory for collision" );
-		return;
+		free( collisionLayer );
+		return false;
 	}
 
-	for( int x = 0; x < map->gridWidth; x++ ) {
-		collisionLayer->collision[x] = sys->realloc( NULL, sizeof( int ) * map->gridHeight );
-		if( collisionLayer->collision[x] == NULL ) {
-			// xxx: It is the caller's responsibility to call the map deletion function and free map->collision
-			prismaticLogger->errorf( "Could not allocate memory for collisionLayer->collision[%d]", x );
-			return;
+	memset( collisionLayer->solid, 0, solidSize + tiles );
+	collisionLayer->values = (uint8_t*)collisionLayer->solid + solidSize;
+
+	// Add the layer before parsing so deleting the map frees it on failure
+	map->_collisionLayerCount += 1;
+	map->collision[map->_collisionLayerCount - 1] = collisionLayer;
+	map->collision[map->_collisionLayerCount] = NULL;
+
+	char buffer[LDTK_CSV_BUFFER_SIZE];
+	size_t tile = 0;
+	// The value being read, -1 between values
+	int value = -1;
+	int readSize = 0;
+
+	while( tile < tiles && ( readSize = pd->file->read( file, buffer, sizeof( buffer ) ) ) > 0 ) {
+
+		for( int i = 0; i < readSize && tile < tiles; i++ ) {
+
+			char c = buffer[i];
+
+			if( c >= '0' && c <= '9' ) {
+				// Stop growing past what a tile can hold, it is clamped below
+				value = value < 0 ? c - '0' : ( value > UINT8_MAX ? value : value * 10 + c - '0' );
+				continue;
+			}
+
+			if( value >= 0 && ( c == ',' || c == '\n' || c == '\r' ) ) {
+				setCollisionValue( map, collisionLayer, tile++, value );
+				value = -1;
+			}
+
 		}
+
+	}
+
+	if( readSize < 0 ) {
+		prismaticLogger->errorf( "Could not read collision csv for layer \"%s\"", layerName );
+		return false;
+	}
+
+	// The last value of a file without a trailing newline
+	if( value >= 0 && tile < tiles ) {
+		setCollisionValue( map, collisionLayer, tile++, value );
+	}
+
+	if( tile < tiles ) {
+		prismaticLogger->errorf( "Collision csv for layer \"%s\" has %d of %d tiles, the rest are empty", layerName, (int)tile, (int)tiles );
+	}
+
+	return mergeCollisionRects( map, collisionLayer, -1, 0 );
+
+}
+
+// Store a tile's value, any non-zero value is solid
+static void setCollisionValue( LDtkTileMap* map, LDtkCollisionLayer* collisionLayer, size_t tile, int value ) {
+
+	collisionLayer->values[tile] = value > UINT8_MAX ? UINT8_MAX : (uint8_t)value;
+
+	if( value != 0 ) {
+		size_t x = tile % map->gridWidth;
+		size_t y = tile / map->gridWidth;
+		collisionLayer->solid[y * solidRowWords( map ) + x / 32] |= (uint32_t)1 << ( x % 32 );
+	}
+
+}
+
+// Cover the layer's tiles holding value, or every solid tile when value is 
+// -1, with as few Sprites as possible, tagged with tag. Each rect starts at 
+// the first uncovered tile, grows right along its row, then grows down while 
+// the whole span below matches and is uncovered.
+static bool mergeCollisionRects( LDtkTileMap* map, LDtkCollisionLayer* collisionLayer, int value, uint8_t tag ) {
+
+	uint8_t* covered = calloc( (size_t)map->gridWidth * map->gridHeight + 1, sizeof( uint8_t ) );
+	if( covered == NULL ) {
+		prismaticLogger->error( "Could not allocate memory for merging collision" );
+		return false;
 	}
 
-	// Build the array
-	const char* ptr = rawCollisionData;
-	int x = 0, y = 0;
-	size_t collisionRects = 0;
+	for( int y = 0; y < map->gridHeight; y++ ) {
 
-    while( y < map->gridHeight ) {
+		uint8_t* row = covered + y * map->gridWidth;
 
-		while( x < map->gridWidth ) {
+		for( int x = 0; x < map->gridWidth; x++ ) {
 
-			// Skip commas
-			if( *ptr == ',' ) {
-				*ptr++;
+			if( !tileMatches( map, collisionLayer, value, x, y ) || row[x] ) {
 				continue;
 			}
 
-            collisionLayer->collision[x][y] = *ptr - '0';
+			int width = 1;
+			while( tileMatches( map, collisionLayer, value, x + width, y ) && !row[x + width] ) {
+				width++;
+			}
+
+			int height = 1;
+			while( y + height < map->gridHeight ) {
 
-			// Create the collision sprites
-			if( collisionLayer->collision[x][y] == 1 ) {
+				uint8_t* below = covered + ( y + height ) * map->gridWidth;
 
-				collisionRects++;
-				collisionLayer->rects = sys->realloc( collisionLayer->rects, sizeof( LCDSprite* ) * collisionRects + 1 );
-				if( collisionLayer->rects == NULL ) {
-					prismaticLogger->error( "Could not allocate memory for collisionLayer->rects" );
-					return;
+				int i = 0;
+				while( i < width && tileMatches( map, collisionLayer, value, x + i, y + height ) && !below[x + i] ) {
+					i++;
 				}
 
-				LCDSprite* col = sprites->newSprite();
-				float xf = (float)(x * map->tileSize);
-				float yf = (float)(y * map->tileSize);
+				if( i < width ) {
+					break;
+				}
 
-				PDRect r = (PDRect){
-					.x = 0.0,
-					.y = 0.0,
-					.width = (float)(map->tileSize),
-					.height = (float)(map->tileSize),
-				};
+				height++;
 
-				sprites->setCenter( col, 0.0, 0.0 );
-				sprites->setCollisionsEnabled( col, 1 );
-				sprites->setBounds( col, r );
-				sprites->setCollideRect( col, r );
-				sprites->setVisible( col, 0 );
-				sprites->moveTo( col, xf, yf );
+			}
 
-				collisionLayer->rects[collisionRects - 1] = col;
-				collisionLayer->rects[collisionRects] = NULL;
+			for( int j = 0; j < height; j++ ) {
+				memset( covered + ( y + j ) * map->gridWidth + x, 1, width );
+			}
 
+			LCDSprite** rects = prismaticArray->reserve( collisionLayer->rects, &collisionLayer->_rectCapacity, collisionLayer->_rectCount + 2, sizeof( LCDSprite* ) );
+			if( rects == NULL ) {
+				prismaticLogger->error( "Could not allocate memory for collisionLayer->rects" );
+				free( covered );
+				return false;
 			}
 
-			*ptr++;
-			x++;
+			collisionLayer->rects = rects;
+			collisionLayer->_rectCount++;
 
-        }		
+			collisionLayer->rects[collisionLayer->_rectCount - 1] = newCollisionRect( map, x, y, width, height );
+			collisionLayer->rects[collisionLayer->_rectCount] = NULL;
+			sprites->setTag( collisionLayer->rects[collisionLayer->_rectCount - 1], tag );
 
-		x = 0;
-		y++;
+			x += width - 1;
 
-    }
+		}
 
-	map->collision[map->_collisionLayerCount - 1] = collisionLayer;
-	map->collision[map->_collisionLayerCount] = NULL;
+	}
+
+	free( covered );
+
+	return true;
+
+}
+
+static bool tileMatches( LDtkTileMap* map, LDtkCollisionLayer* collisionLayer, int value, int x, int y ) {
+
+	if( value < 0 ) {
+		return isSolidLDtkTileMap( map, collisionLayer, x, y );
+	}
+
+	return x < map->gridWidth && y < map->gridHeight && collisionLayer->values[y * map->gridWidth + x] == value;
+
+}
+
+static void freeCollisionRects( LDtkCollisionLayer* collisionLayer ) {
+
+	if( collisionLayer->rects == NULL ) {
+		return;
+	}
+
+	for( size_t i = 0; collisionLayer->rects[i] != NULL; i++ ) {
+		sprites->removeSprite( collisionLayer->rects[i] );
+		sprites->freeSprite( collisionLayer->rects[i] );
+	}
+
+	collisionLayer->rects = prismaticArray->release( collisionLayer->rects, &collisionLayer->_rectCapacity );
+	collisionLayer->_rectCount = 0;
+
+}
+
+// Words in each row of a layer's solid bits
+static size_t solidRowWords( LDtkTileMap* map ) {
+	return ( (size_t)map->gridWidth + 31 ) / 32;
+}
+
+static bool solidBit( const uint32_t* row, int x ) {
+	return ( row[x / 32] >> ( x % 32 ) ) & 1;
+}
+
+// Create the hidden Sprite colliding with width by height tiles from x, y
+static LCDSprite* newCollisionRect( LDtkTileMap* map, int x, int y, int width, int height ) {
+
+	LCDSprite* col = sprites->newSprite();
+	float xf = (float)(x * map->tileSize);
+	float yf = (float)(y * map->tileSize);
+
+	PDRect r = (PDRect){
+		.x = 0.0,
+		.y = 0.0,
+		.width = (float)(width * map->tileSize),
+		.height = (float)(height * map->tileSize),
+	};
+
+	sprites->setCenter( col, 0.0, 0.0 );
+	sprites->setCollisionsEnabled( col, 1 );
+	sprites->setBounds( col, r );
+	sprites->setCollideRect( col, r );
+	sprites->setVisible( col, 0 );
+	sprites->moveTo( col, xf, yf );
+
+	return col;
 
 }
 
 // JSON Parsing
 
+// Map a key to the LDtkKey it names. No two keys share both a length and a 
+// first character, so the length and first character pick the only key it 
+// can be, and a single strcmp confirms it. Unknown lengths need no strcmp.
+static LDtkKey matchKey( const char* key ) {
+
+	if( key == NULL ) {
+		return LDtkKey_Unknown;
+	}
+
+	LDtkKey match = LDtkKey_Unknown;
+	const char* name = NULL;
+
+	switch( strlen( key ) ) {
+
+		case 1:
+			return key[0] == 'x' ? LDtkKey_X : key[0] == 'y' ? LDtkKey_Y : LDtkKey_Unknown;
+
+		case 2:
+			match = LDtkKey_Id;
+			name = "id";
+			break;
+
+		case 3:
+			match = key[0] == 'd' ? LDtkKey_Dir : LDtkKey_Iid;
+			name = key[0] == 'd' ? "dir" : "iid";
+			break;
+
+		case 5:
+			match = key[0] == 'w' ? LDtkKey_Width : LDtkKey_Layer;
+			name = key[0] == 'w' ? "width" : "layer";
+			break;
+
+		case 6:
+			match = key[0] == 'h' ? LDtkKey_Height : LDtkKey_Layers;
+			name = key[0] == 'h' ? "height" : "layers";
+			break;
+
+		case 7:
+			match = LDtkKey_BgColor;
+			name = "bgColor";
+			break;
+
+		case 8:
+			match = key[0] == 'e' ? LDtkKey_Entities : LDtkKey_LevelIid;
+			name = key[0] == 'e' ? "entities" : "levelIid";
+			break;
+
+		case 10:
+			match = LDtkKey_Identifier;
+			name = "identifier";
+			break;
+
+		case 12:
+			match = LDtkKey_CustomFields;
+			name = "customFields";
+			break;
+
+		case 15:
+			// fixme: intentional typo - LDtk Exports this way, fix when LDtk fixes their json
+			match = key[0] == 'u' ? LDtkKey_UniqueIdentifer : LDtkKey_NeighbourLevels;
+			name = key[0] == 'u' ? "uniqueIdentifer" : "neighbourLevels";
+			break;
+
+		default:
+			return LDtkKey_Unknown;
+
+	}
+
+	return strcmp( key, name ) == 0 ? match : LDtkKey_Unknown;
+
+}
+
 static void decodeError( json_decoder* decoder, const char* error, int linenum ) {
 	prismaticLogger->errorf( "Error decoding TileMap: '%s' at line %d", error, linenum );
 }
 
 static void willDecodeSublist( json_decoder* decoder, const char* name, json_value_type type ) {
 	
-	if( prismaticString->equals( "layers", name ) ) {
-		decoder->didDecodeArrayValue = decodeLayers;
-		return;
-	}
+	switch( matchKey( name ) ) {
 
-	if( prismaticString->contains( "neighbourLevels", name ) ) {
-		decoder->shouldDecodeArrayValueAtIndex = newNeighbor;
-		decoder->didDecodeTableValue = decodeNeighbor;
-		return;
-	}
+		case LDtkKey_Layers:
+			decoder->didDecodeArrayValue = decodeLayers;
+			break;
+
+		case LDtkKey_NeighbourLevels:
+			decoder->shouldDecodeArrayValueAtIndex = newNeighbor;
+			decoder->didDecodeTableValue = decodeNeighbor;
+			break;
+
+		case LDtkKey_Entities:
+			decoder->shouldDecodeTableValueForKey = newEntityGroup;
+			decoder->willDecodeSublist = decodeEntityGroup;
+			decoder->shouldDecodeArrayValueAtIndex = newEntity;
+			break;
+
+		default:
+			break;
 
-	if( prismaticString->equals( "entities", name ) ) {
-		decoder->shouldDecodeTableValueForKey = newEntityGroup;
-		decoder->willDecodeSublist = decodeEntityGroup;
-		decoder->shouldDecodeArrayValueAtIndex = newEntity;
-		return;
 	}
 
 }
@@ -634,17 +1571,22 @@ static int shouldDecodeTableValueForKey( json_decoder* decoder, const char* key
 	
 	LDtkTileMap* map = decoder->userdata;
 
-	if( prismaticString->equals( "bgColor", key ) ) {
-		return 0;
-	}
+	switch( matchKey( key ) ) {
 
-	if( prismaticString->equals( "customFields", key ) ) {
-		
-		if( map->_customFieldHandler == NULL ) {
+		case LDtkKey_BgColor:
 			return 0;
-		}
 
-		decoder->shouldDecodeTableValueForKey = map->_customFieldHandler->decodeFields;
+		case LDtkKey_CustomFields:
+
+			if( map->_customFieldHandler == NULL ) {
+				return 0;
+			}
+
+			decoder->shouldDecodeTableValueForKey = map->_customFieldHandler->decodeFields;
+			break;
+
+		default:
+			break;
 
 	}
 
@@ -656,40 +1598,39 @@ static void didDecodeTableValue( json_decoder* decoder, const char* key, json_va
 
 	LDtkTileMap* map = decoder->userdata;
 
-	if( prismaticString->equals( "identifier", key ) ) {
-		map->id = prismaticString->new( json_stringValue( value ) );
-		return;
-	}
+	switch( matchKey( key ) ) {
 
-	// fixme: intentional typo - LDtk Exports this way, fix when LDtk fixes their json
-	if( prismaticString->equals( "uniqueIdentifer", key ) ) {
-		map->iid = prismaticString->new( json_stringValue( value ) );
-		return;
-	}
+		case LDtkKey_Identifier:
+			map->id = prismaticString->new( json_stringValue( value ) );
+			break;
 
-	if( prismaticString->equals( "x", key ) ) {
-		map->worldX = json_intValue( value );
-		return;
-	}
+		case LDtkKey_UniqueIdentifer:
+			map->iid = prismaticString->new( json_stringValue( value ) );
+			break;
 
-	if( prismaticString->equals( "y", key ) ) {
-		map->worldY = json_intValue( value );
-		return;
-	}
+		case LDtkKey_X:
+			map->worldX = json_intValue( value );
+			break;
 
-	if( prismaticString->equals( "width", key ) ) {
-		map->width = json_intValue( value );
-		return;
-	}
+		case LDtkKey_Y:
+			map->worldY = json_intValue( value );
+			break;
 
-	if( prismaticString->equals( "height", key ) ) {
-		map->height = json_intValue( value );
-		return;
-	}
+		case LDtkKey_Width:
+			map->width = json_intValue( value );
+			break;
+
+		case LDtkKey_Height:
+			map->height = json_intValue( value );
+			break;
+
+		case LDtkKey_CustomFields:
+			decoder->shouldDecodeTableValueForKey = shouldDecodeTableValueForKey;
+			break;
+
+		default:
+			break;
 
-	if( prismaticString->equals( "customFields", key ) ) {
-		decoder->shouldDecodeTableValueForKey = shouldDecodeTableValueForKey;
-		return;
 	}
 
 }
@@ -704,11 +1645,8 @@ static void didDecodeArrayValue( json_decoder* decoder, int pos, json_value valu
 
 static void* didDecodeSublist( json_decoder* decoder, const char* name, json_value_type type ) {
 
-	if( 
-		!prismaticString->equals( name, "layers" ) 
-		&& !prismaticString->equals( name, "neighbourLevels" ) 
-		&& !prismaticString->equals( name, "entities" ) 
-	) {
+	LDtkKey key = matchKey( name );
+	if( key != LDtkKey_Layers && key != LDtkKey_NeighbourLevels && key != LDtkKey_Entities ) {
 		return NULL;
 	}
 
@@ -730,53 +1668,38 @@ static void decodeLayers( json_decoder* decoder, int pos, json_value value ) {
 		return;
 	}
 
+	// Only record the layer here, its image is loaded in its own step
 	layer->filename = prismaticString->new( json_stringValue( value ) );
-
-	string layerPath = prismaticString->new( map->_path );
-	prismaticString->concat( &layerPath, "/" );
-	prismaticString->concat( &layerPath, layer->filename );
-
-	string err = NULL;
-	layer->image = graphics->loadBitmap( layerPath, &err );
-
-	if( err != NULL ) {
-		prismaticLogger->errorf( "%s", err );
-	}
-
-	if( layer->image == NULL ) {
-		prismaticLogger->errorf( "Layer image at %s could not be loaded!", layerPath );
-	}
-
 	layer->zIndex = pos;
 
-	map->_layerCount += 1;
-	map->layers = sys->realloc( map->layers, sizeof( LDtkLayer* ) * map->_layerCount + 1 );
+	LDtkLayer** layers = prismaticArray->reserve( map->layers, &map->_layerCapacity, map->_layerCount + 2, sizeof( LDtkLayer* ) );
 
-	if( map->layers == NULL ) {
+	if( layers == NULL ) {
         prismaticLogger->errorf( "Memory allocation failed for adding layer: %s", layer->filename );
-		prismaticString->delete( layerPath );
 		freeLayer( layer );
         return;
     }
     
+    map->layers = layers;
+    map->_layerCount += 1;
     map->layers[map->_layerCount - 1] = layer;
     map->layers[map->_layerCount] = NULL;
 
-	prismaticString->delete( layerPath );
-
 }
 
 static int newNeighbor( json_decoder* decoder, int pos ) {
 	
 	LDtkTileMap* map = decoder->userdata;
 
-	map->_neighborCount++;
-	map->neighborLevels = sys->realloc( map->neighborLevels, map->_neighborCount * sizeof( LDtkTileMapRef* ) + 1 );
-	if( map->neighborLevels == NULL ) {
+	LDtkTileMapRef** neighborLevels = prismaticArray->reserve( map->neighborLevels, &map->_neighborCapacity, map->_neighborCount + 2, sizeof( LDtkTileMapRef* ) );
+	if( neighborLevels == NULL ) {
 		prismaticLogger->error( "Could not allocate memory for neighborLevels!" );
 		return 0;
 	}
 
+	map->neighborLevels = neighborLevels;
+	map->_neighborCount++;
+
 	map->neighborLevels[map->_neighborCount - 1] = calloc( 1, sizeof( LDtkTileMapRef ) );
 	map->neighborLevels[map->_neighborCount] = NULL;
 	
@@ -789,14 +1712,19 @@ static void decodeNeighbor( json_decoder* decoder, const char* key, json_value v
 	LDtkTileMap* map = decoder->userdata;
 	LDtkTileMapRef* neighbor = map->neighborLevels[map->_neighborCount - 1];
 
-	if( prismaticString->equals( "levelIid", key ) ) {
-		neighbor->levelIid = prismaticString->new( json_stringValue( value ) );
-		return;
-	}
+	switch( matchKey( key ) ) {
+
+		case LDtkKey_LevelIid:
+			neighbor->levelIid = prismaticString->new( json_stringValue( value ) );
+			break;
+
+		case LDtkKey_Dir:
+			neighbor->dir = prismaticString->new( json_stringValue( value ) );
+			break;
+
+		default:
+			break;
 
-	if( prismaticString->equals( "dir", key ) ) {
-		neighbor->dir = prismaticString->new( json_stringValue( value ) );
-		return;
 	}
 
 }
@@ -805,13 +1733,15 @@ static int newEntityGroup( json_decoder* decoder, const char* key ) {
 
 	LDtkTileMap* map = decoder->userdata;
 
-	map->_entityGroupCount++;
-	map->entities = sys->realloc( map->entities, map->_entityGroupCount * sizeof( LDtkEntityGroup* ) + 1 );
-	if( map->entities == NULL ) {
+	LDtkEntityGroup** entities = prismaticArray->reserve( map->entities, &map->_entityGroupCapacity, map->_entityGroupCount + 2, sizeof( LDtkEntityGroup* ) );
+	if( entities == NULL ) {
 		prismaticLogger->error( "Could not allocate memory for entities!" );
 		return 0;
 	}
 
+	map->entities = entities;
+	map->_entityGroupCount++;
+
 	map->entities[map->_entityGroupCount - 1] = calloc( 1, sizeof( LDtkEntityGroup ) );
 	map->entities[map->_entityGroupCount] = NULL;
 
@@ -849,13 +1779,15 @@ static int newEntity( json_decoder* decoder, int pos ) {
 
 	LDtkEntityGroup* group = map->entities[map->_entityGroupCount - 1];
 	
-	group->_entityCount++;
-	group->entities = sys->realloc( group->entities, group->_entityCount * sizeof( LDtkEntity* ) + 1 );
-	if( group->entities == NULL ) {
+	LDtkEntity** entities = prismaticArray->reserve( group->entities, &group->_entityCapacity, group->_entityCount + 2, sizeof( LDtkEntity* ) );
+	if( entities == NULL ) {
 		prismaticLogger->error( "Could not allocate memory for entity!" );
 		return 0;
 	}
 
+	group->entities = entities;
+	group->_entityCount++;
+
 	group->entities[group->_entityCount - 1] = calloc( 1, sizeof( LDtkEntity ) );
 	group->entities[group->_entityCount] = NULL;
 
@@ -882,32 +1814,39 @@ static void decodeEntity( json_decoder* decoder, const char* key, json_value val
 
 	LDtkEntity* entity = group->entities[group->_entityCount - 1];
 
-	if( prismaticString->equals( key, "id" ) ) {
-		entity->id = prismaticString->new( json_stringValue( value ) );
-	}
+	switch( matchKey( key ) ) {
 
-	if( prismaticString->equals( key, "iid" ) ) {
-		entity->iid = prismaticString->new( json_stringValue( value ) );
-	}
+		case LDtkKey_Id:
+			entity->id = prismaticString->new( json_stringValue( value ) );
+			break;
 
-	if( prismaticString->equals( key, "layer" ) ) {
-		entity->layer = prismaticString->new( json_stringValue( value ) );
-	}
+		case LDtkKey_Iid:
+			entity->iid = prismaticString->new( json_stringValue( value ) );
+			break;
 
-	if( prismaticString->equals( key, "x" ) ) {
-		entity->x = json_intValue( value );
-	}
+		case LDtkKey_Layer:
+			entity->layer = prismaticString->new( json_stringValue( value ) );
+			break;
 
-	if( prismaticString->equals( key, "y" ) ) {
-		entity->y = json_intValue( value );
-	}
+		case LDtkKey_X:
+			entity->x = json_intValue( value );
+			break;
 
-	if( prismaticString->equals( key, "width" ) ) {
-		entity->width = json_intValue( value );
-	}
+		case LDtkKey_Y:
+			entity->y = json_intValue( value );
+			break;
+
+		case LDtkKey_Width:
+			entity->width = json_intValue( value );
+			break;
+
+		case LDtkKey_Height:
+			entity->height = json_intValue( value );
+			break;
+
+		default:
+			break;
 
-	if( prismaticString->equals( key, "height" ) ) {
-		entity->height = json_intValue( value );
 	}
 
 }
@@ -931,7 +1870,7 @@ static void freeLayer( LDtkLayer* layer ) {
 	prismaticString->delete( layer->filename );
 
 	if( layer->image != NULL ) {
-		graphics->freeBitmap( layer->image );
+		prismaticAssets->release( layer->image );
 	}
 
 	free( layer );
@@ -951,8 +1890,7 @@ static LDtkMapManager* newMapManager() {
 static void deleteMapManager( LDtkMapManager* mapManager ) {
 
 	if( mapManager->maps != NULL ) {
-		mapManager->maps = sys->realloc( mapManager->maps, 0 );
-		mapManager->maps = NULL;
+		mapManager->maps = prismaticArray->release( mapManager->maps, &mapManager->_mapCapacity );
 		mapManager->_mapCount = 0;
 	}
 
@@ -984,13 +1922,14 @@ static void addMapManager( LDtkMapManager* mapManager, LDtkTileMap* map ) {
 		}
 	}
 
-	mapManager->_mapCount++;
-	mapManager->maps = sys->realloc( mapManager->maps, sizeof( LDtkTileMap* ) * mapManager->_mapCount + 1 );
-	if( mapManager == NULL ) {
+	LDtkTileMap** maps = prismaticArray->reserve( mapManager->maps, &mapManager->_mapCapacity, mapManager->_mapCount + 2, sizeof( LDtkTileMap* ) );
+	if( maps == NULL ) {
 		prismaticLogger->error( "Could not allocate memory for MapManager maps" );
 		return;
 	}
 
+	mapManager->maps = maps;
+	mapManager->_mapCount++;
 	mapManager->maps[mapManager->_mapCount - 1] = map;
 	mapManager->maps[mapManager->_mapCount] = NULL;
 
@@ -1032,13 +1971,8 @@ static void removeMapManager( LDtkMapManager* mapManager, string mapId ) {
 		mapManager->maps[j] = mapManager->maps[j + 1];
 	}
 
-	// Reallocate the memory for mapManager->maps
+	// Keep the capacity, the shift above already moved the NULL terminator
 	mapManager->_mapCount--;
-	mapManager->maps = sys->realloc( mapManager->maps, sizeof( LDtkTileMap* ) * mapManager->_mapCount + 1 );
-	if( mapManager == NULL ) {
-		prismaticLogger->error( "Could not reallocate memory for MapManager maps" );
-		return;
-	}
 
 }
 
@@ -1130,6 +2064,9 @@ static void changeMap( LDtkMapManager* mapManager, LDtkTileMap* map ) {
 
 const LDtkTileMapFn* prismaticTileMap = &( LDtkTileMapFn ){
 	.new = newLDtkTileMap,
+	.newDeferred = newDeferredLDtkTileMap,
+	.loadStep = loadStepLDtkTileMap,
+	.newFromBinary = newBinaryLDtkTileMap,
 	.delete = deleteLDtkTileMap,
 	.draw = drawLDtkTileMap,
 	.add = addLDtkTileMap,
@@ -1137,6 +2074,12 @@ const LDtkTileMapFn* prismaticTileMap = &( LDtkTileMapFn ){
 	.addCollision = addCollisionLDtkTileMap,
 	.removeCollision = removeCollisionLDtkTileMap,
 	.tagCollision = tagCollisionLDtkTileMap,
+	.tagValues = tagValuesLDtkTileMap,
+	.getCollision = getCollisionLDtkTileMap,
+	.isSolid = isSolidLDtkTileMap,
+	.getValue = getValueLDtkTileMap,
+	.getSolidRow = getSolidRowLDtkTileMap,
+	.worldToTile = worldToTileLDtkTileMap,
 };
 
 const LDtkMapManagerFn* prismaticMapManager = &( LDtkMapManagerFn ){
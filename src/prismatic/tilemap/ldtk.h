@@ -32,6 +32,7 @@ typedef struct LDtkEntity {
 typedef struct LDtkEntityGroup {
 	string type;
 	size_t _entityCount;
+	size_t _entityCapacity;
 	LDtkEntity** entities;
 } LDtkEntityGroup;
 
@@ -42,15 +43,39 @@ typedef struct LDtkTileMapRef {
 
 typedef struct LDtkCollisionLayer {
 	string name;
-	int** collision;
+	// The IntGrid value of each tile, row by row: values[ty * gridWidth + tx]
+	uint8_t* values;
+	// One bit per tile, set where the tile is solid, by default any tile with
+	// a non-zero value. Each row is 
+	// ( gridWidth + 31 ) / 32 words, see prismaticTileMap->getSolidRow
+	uint32_t* solid;
+	size_t _rectCount;
+	size_t _rectCapacity;
 	LCDSprite** rects;
 } LDtkCollisionLayer;
 
+// An entry of the table given to prismaticTileMap->tagValues
+typedef struct LDtkCollisionTag {
+	// The IntGrid value
+	uint8_t value;
+	// The Sprite tag of the value's collision Sprites
+	uint8_t tag;
+} LDtkCollisionTag;
+
 typedef struct LDtkFieldHandler {
 	// Used for handling custom fields during map decoding
 	int ( *decodeFields )( json_decoder* decoder, const char* key );
 } LDtkFieldHandler;
 
+// The loading progress of an LDtkTileMap, see prismaticTileMap->loadStep
+typedef enum {
+	LDtkLoadStage_Json,
+	LDtkLoadStage_Layers,
+	LDtkLoadStage_Collision,
+	LDtkLoadStage_Done,
+	LDtkLoadStage_Failed,
+} LDtkLoadStage;
+
 typedef struct LDtkTileMap {
 	string id;
 	string iid;
@@ -62,16 +87,31 @@ typedef struct LDtkTileMap {
 	int gridHeight;
 	int gridWidth;
 	size_t _collisionLayerCount;
+	size_t _collisionLayerCapacity;
 	LDtkCollisionLayer** collision;
 	size_t _neighborCount;
+	size_t _neighborCapacity;
 	LDtkTileMapRef** neighborLevels;
 	size_t _layerCount;
+	size_t _layerCapacity;
 	LDtkLayer** layers;
 	size_t _entityGroupCount;
+	size_t _entityGroupCapacity;
 	LDtkEntityGroup** entities;
 	size_t _layerSpriteCount;
+	size_t _layerSpriteCapacity;
 	LCDSprite** _layerSprites;
 	string _path;
+	// Loading progress, and the layer or collision file loaded next
+	LDtkLoadStage _loadStage;
+	size_t _loadIndex;
+	// Collision layer names still to be loaded, NULL once loading is done
+	string* _collisionLayers;
+	// The binary map every string, layer, entity and collision layer points
+	// into, NULL unless created with prismaticTileMap->newFromBinary
+	void* _blob;
+	// Whether the collision Sprites are on the display list, see addCollision
+	bool _collisionAdded;
 	// Used for handling custom fields during map decoding, caller is responsible
 	// for freeing the pointer.
 	LDtkFieldHandler* _customFieldHandler;
@@ -94,6 +134,7 @@ typedef struct LDtkTileMap {
 
 typedef struct LDtkMapManager {
 	size_t _mapCount;
+	size_t _mapCapacity;
 	LDtkTileMap** maps;
 	LDtkTileMap* currentMap;
 	LDtkTileMap* previousMap;
@@ -117,6 +158,49 @@ typedef struct LDtkTileMapFn {
 	// LDtkFieldHandler* customFieldHandler 
 	LDtkTileMap* ( *new )( string, int, string*, LDtkFieldHandler* );
 
+	// Create a new LDtkTileMap from the path without loading anything yet
+	//
+	// Call loadStep until it returns LDtkLoadStage_Done to load the map a
+	// piece at a time, for example from a Scene's load function. Takes the
+	// same arguments as new. The collision layer list is copied, so it may 
+	// be freed straight away, but the names themselves must outlive the map.
+	//
+	// ----
+	// 
+	// string path
+	//
+	// int tileSize
+	//
+	// string* collisionLayers
+	// 
+	// LDtkFieldHandler* customFieldHandler 
+	LDtkTileMap* ( *newDeferred )( string, int, string*, LDtkFieldHandler* );
+
+	// Run the next step of loading a map created with newDeferred
+	//
+	// Each step does one piece of I/O: decoding the JSON, loading one layer 
+	// image, or parsing one collision csv. Returns the stage the map is in 
+	// after the step. On LDtkLoadStage_Failed it is up to the caller to 
+	// delete the map.
+	//
+	// ----
+	//
+	// LDtkTileMap* map
+	LDtkLoadStage ( *loadStep )( LDtkTileMap* );
+
+	// Create a new LDtkTileMap from a binary map cooked by tools/ldtkcook.py
+	//
+	// The file is read with a single read into one allocation, and the map's 
+	// strings, layers, entities and collision all point into it, so nothing 
+	// is decoded on load. Layer images are loaded from the binary's 
+	// directory. Custom fields are not cooked, use new for an 
+	// LDtkFieldHandler.
+	//
+	// ----
+	//
+	// string path - Path to the binary map, e.g. "assets/maps/Level_0/data.bin"
+	LDtkTileMap* ( *newFromBinary )( string );
+
 	// Delete the LDtkTileMap
 	//
 	// ----
@@ -184,6 +268,91 @@ typedef struct LDtkTileMapFn {
 	//
 	// uint8_t tag 
 	void ( *tagCollision )( LDtkTileMap*, string, uint8_t );
+
+	// Rebuild a collision layer's Sprites from a table of IntGrid values to 
+	// tags, so one layer can hold walls, floors and hazards
+	//
+	// Each value in the table gets its own Sprites, tagged with its tag. 
+	// Only values in the table are solid afterwards, and a value listed twice 
+	// keeps its first tag. Call once the map has loaded, if its collision has 
+	// been added the new Sprites replace the old ones on the display list.
+	//
+	// ---
+	//
+	// LDtkTileMap* map
+	//
+	// string layerName
+	//
+	// const LDtkCollisionTag* tags
+	//
+	// size_t count - The number of entries in tags
+	void ( *tagValues )( LDtkTileMap*, string, const LDtkCollisionTag*, size_t );
+
+	// Get a map's collision layer by name, or NULL if it has none by that name
+	//
+	// ---
+	//
+	// LDtkTileMap* map
+	//
+	// string layerName
+	LDtkCollisionLayer* ( *getCollision )( LDtkTileMap*, string );
+
+	// Whether the tile at tx, ty of a collision layer is solid. Tiles outside 
+	// the map are not.
+	//
+	// ---
+	//
+	// LDtkTileMap* map
+	//
+	// LDtkCollisionLayer* layer
+	//
+	// int tx
+	//
+	// int ty
+	bool ( *isSolid )( LDtkTileMap*, LDtkCollisionLayer*, int, int );
+
+	// Get the IntGrid value of the tile at tx, ty of a collision layer, 0 for
+	// tiles outside the map
+	//
+	// ---
+	//
+	// LDtkTileMap* map
+	//
+	// LDtkCollisionLayer* layer
+	//
+	// int tx
+	//
+	// int ty
+	uint8_t ( *getValue )( LDtkTileMap*, LDtkCollisionLayer*, int, int );
+
+	// Get the solid bits of row ty of a collision layer, or NULL outside the
+	// map. Tile tx is bit tx % 32 of word tx / 32, bits past the map's width
+	// are clear.
+	//
+	// ---
+	//
+	// LDtkTileMap* map
+	//
+	// LDtkCollisionLayer* layer
+	//
+	// int ty
+	const uint32_t* ( *getSolidRow )( LDtkTileMap*, LDtkCollisionLayer*, int );
+
+	// Convert a world position to the tile under it, taking the map's world
+	// position into account. The tile may be outside the map.
+	//
+	// ---
+	//
+	// LDtkTileMap* map
+	//
+	// float x
+	//
+	// float y
+	//
+	// int* tx - Set to the tile's column
+	//
+	// int* ty - Set to the tile's row
+	void ( *worldToTile )( LDtkTileMap*, float, float, int*, int* );
 } LDtkTileMapFn;
 
 typedef struct LDtkMapManagerFn {
@@ -42,6 +42,11 @@ static PrismTransition* newTransition( LCDBitmap* image, int x, int y, float spe
     transition->runTime = 0.0f;
     transition->flipped = kBitmapUnflipped;
     transition->image = image;
+
+    // Hold on to cached images, so the transition outlives whoever loaded it
+    if( prismaticAssets->retain( image ) ) {
+        transition->_retainedImage = image;
+    }
     transition->_pass = false;
     transition->completeDelay = 0;
 
@@ -135,6 +140,10 @@ static void deleteTransition( PrismTransition* transition ) {
         graphics->freeBitmap( transition->mask );
     }
 
+    if( transition->_retainedImage != NULL ) {
+        prismaticAssets->release( transition->_retainedImage );
+    }
+
     free( transition );
     transition = NULL;
 
@@ -56,6 +56,9 @@ typedef struct PrismTransition {
 	LCDBitmap* mask;
 	LCDBitmap* image;
 	LCDBitmap* _rendered;
+	// image, if it was loaded through prismaticAssets. Kept loaded until the
+	// PrismTransition is deleted.
+	LCDBitmap* _retainedImage;
 	bool finished;
 	uint8_t _exp1;
 	uint8_t _exp2;
@@ -88,7 +91,8 @@ typedef struct PrismTransition {
 typedef struct TransitionFn {
 	// Create a new PrismTransition
 	// 
-	// LCDBitmap* image - The image to transition. Caller is responsible for freeing this bitmap
+	// LCDBitmap* image - The image to transition. Caller is responsible for freeing this bitmap.
+	// Images loaded through prismaticAssets are kept loaded until the transition is deleted.
 	// 
 	// int x - The x position to draw the transition
 	//
@@ -0,0 +1,618 @@
+// bench_keys.c
+//
+// Replays the keys of LDtk data.json exports through the decoder's key
+// dispatch, once with matchKey and once with the prismaticString->equals
+// chains it replaced. Each key goes to the callbacks the Playdate decoder
+// would call for it, so the old chains see the keys in the order and
+// context they did before.
+//
+//     tools/host/_build/bench_keys [data.json ...] [--entities count]
+//
+// --entities also replays a generated level with that many entities, each 
+// with custom fields, spread over a few entity groups.
+
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "host.h"
+
+// For the static matchKey
+#include "../../src/prismatic/tilemap/ldtk.c"
+
+#define BENCH_TARGET_KEYS 20000000
+#define BENCH_MAX_DEPTH 32
+
+typedef enum {
+	KeyContext_None,
+	KeyContext_Level,
+	KeyContext_Neighbor,
+	KeyContext_Entity,
+} KeyContext;
+
+typedef struct StreamKey {
+	char* key;
+	KeyContext context;
+	bool sublist;
+} StreamKey;
+
+typedef struct KeyStream {
+	StreamKey* keys;
+	size_t count;
+	size_t capacity;
+} KeyStream;
+
+typedef struct Container {
+	char type;
+	char* key;
+} Container;
+
+typedef struct JsonBuffer {
+	char* text;
+	size_t length;
+	size_t capacity;
+} JsonBuffer;
+
+// The Old Chains, taking string as prismaticString->equals does
+
+static int oldWillDecodeSublist( string name ) {
+
+	if( prismaticString->equals( "layers", name ) ) {
+		return 1;
+	}
+
+	if( prismaticString->contains( "neighbourLevels", name ) ) {
+		return 2;
+	}
+
+	if( prismaticString->equals( "entities", name ) ) {
+		return 3;
+	}
+
+	return 0;
+
+}
+
+static int oldShouldDecodeTableValueForKey( string key ) {
+
+	if( prismaticString->equals( "bgColor", key ) ) {
+		return 4;
+	}
+
+	if( prismaticString->equals( "customFields", key ) ) {
+		return 5;
+	}
+
+	return 0;
+
+}
+
+static int oldDidDecodeTableValue( string key ) {
+
+	if( prismaticString->equals( "identifier", key ) ) {
+		return 6;
+	}
+
+	if( prismaticString->equals( "uniqueIdentifer", key ) ) {
+		return 7;
+	}
+
+	if( prismaticString->equals( "x", key ) ) {
+		return 8;
+	}
+
+	if( prismaticString->equals( "y", key ) ) {
+		return 9;
+	}
+
+	if( prismaticString->equals( "width", key ) ) {
+		return 10;
+	}
+
+	if( prismaticString->equals( "height", key ) ) {
+		return 11;
+	}
+
+	if( prismaticString->equals( "customFields", key ) ) {
+		return 5;
+	}
+
+	return 0;
+
+}
+
+static int oldDidDecodeSublist( string name ) {
+
+	if(
+		!prismaticString->equals( name, "layers" )
+		&& !prismaticString->equals( name, "neighbourLevels" )
+		&& !prismaticString->equals( name, "entities" )
+	) {
+		return 0;
+	}
+
+	return 12;
+
+}
+
+static int oldDecodeNeighbor( string key ) {
+
+	if( prismaticString->equals( "levelIid", key ) ) {
+		return 13;
+	}
+
+	if( prismaticString->equals( "dir", key ) ) {
+		return 14;
+	}
+
+	return 0;
+
+}
+
+// Every test ran, the old decodeEntity had no early returns
+static int oldDecodeEntity( string key ) {
+
+	int action = 0;
+
+	if( prismaticString->equals( key, "id" ) ) action = 15;
+	if( prismaticString->equals( key, "iid" ) ) action = 16;
+	if( prismaticString->equals( key, "layer" ) ) action = 17;
+	if( prismaticString->equals( key, "x" ) ) action = 8;
+	if( prismaticString->equals( key, "y" ) ) action = 9;
+	if( prismaticString->equals( key, "width" ) ) action = 10;
+	if( prismaticString->equals( key, "height" ) ) action = 11;
+
+	return action;
+
+}
+
+static int oldDispatch( const StreamKey* key ) {
+
+	switch( key->context ) {
+
+		case KeyContext_Level:
+
+			if( oldShouldDecodeTableValueForKey( key->key ) == 4 ) {
+				return 4;
+			}
+
+			if( key->sublist ) {
+				return oldWillDecodeSublist( key->key ) + oldDidDecodeSublist( key->key );
+			}
+
+			return oldDidDecodeTableValue( key->key );
+
+		case KeyContext_Neighbor:
+			return oldDecodeNeighbor( key->key );
+
+		case KeyContext_Entity:
+			return oldDecodeEntity( key->key );
+
+		case KeyContext_None:
+			break;
+
+	}
+
+	return 0;
+
+}
+
+// The Same Callbacks Through matchKey
+
+static int newLevelValue( LDtkKey key ) {
+
+	switch( key ) {
+		case LDtkKey_Identifier: return 6;
+		case LDtkKey_UniqueIdentifer: return 7;
+		case LDtkKey_X: return 8;
+		case LDtkKey_Y: return 9;
+		case LDtkKey_Width: return 10;
+		case LDtkKey_Height: return 11;
+		case LDtkKey_CustomFields: return 5;
+		default: return 0;
+	}
+
+}
+
+static int newWillDecodeSublist( LDtkKey key ) {
+
+	switch( key ) {
+		case LDtkKey_Layers: return 1;
+		case LDtkKey_NeighbourLevels: return 2;
+		case LDtkKey_Entities: return 3;
+		default: return 0;
+	}
+
+}
+
+static int newDidDecodeSublist( LDtkKey key ) {
+	return key == LDtkKey_Layers || key == LDtkKey_NeighbourLevels || key == LDtkKey_Entities ? 12 : 0;
+}
+
+static int newEntityValue( LDtkKey key ) {
+
+	switch( key ) {
+		case LDtkKey_Id: return 15;
+		case LDtkKey_Iid: return 16;
+		case LDtkKey_Layer: return 17;
+		case LDtkKey_X: return 8;
+		case LDtkKey_Y: return 9;
+		case LDtkKey_Width: return 10;
+		case LDtkKey_Height: return 11;
+		default: return 0;
+	}
+
+}
+
+// Each decoder callback calls matchKey itself, as ldtk.c does
+static int newDispatch( const StreamKey* key ) {
+
+	switch( key->context ) {
+
+		case KeyContext_Level:
+
+			if( matchKey( key->key ) == LDtkKey_BgColor ) {
+				return 4;
+			}
+
+			if( key->sublist ) {
+				return newWillDecodeSublist( matchKey( key->key ) ) + newDidDecodeSublist( matchKey( key->key ) );
+			}
+
+			return newLevelValue( matchKey( key->key ) );
+
+		case KeyContext_Neighbor: {
+			LDtkKey match = matchKey( key->key );
+			return match == LDtkKey_LevelIid ? 13 : match == LDtkKey_Dir ? 14 : 0;
+		}
+
+		case KeyContext_Entity:
+			return newEntityValue( matchKey( key->key ) );
+
+		case KeyContext_None:
+			break;
+
+	}
+
+	return 0;
+
+}
+
+// Reading Key Streams
+
+static bool pushKey( KeyStream* stream, char* key, KeyContext context, bool sublist ) {
+
+	StreamKey* keys = prismaticArray->reserve( stream->keys, &stream->capacity, stream->count + 1, sizeof( StreamKey ) );
+	if( keys == NULL ) {
+		return false;
+	}
+
+	stream->keys = keys;
+	stream->keys[stream->count++] = (StreamKey){ .key = key, .context = context, .sublist = sublist };
+
+	return true;
+
+}
+
+// Copy the JSON string starting at the quote at *cursor, leaving *cursor
+// just past its closing quote
+static char* readString( const char** cursor ) {
+
+	const char* start = *cursor + 1;
+	const char* end = start;
+	while( *end != '\0' && *end != '"' ) {
+		end += ( *end == '\\' && end[1] != '\0' ) ? 2 : 1;
+	}
+
+	char* value = calloc( end - start + 1, 1 );
+	memcpy( value, start, end - start );
+
+	*cursor = *end == '"' ? end + 1 : end;
+
+	return value;
+
+}
+
+static const char* skipSpace( const char* cursor ) {
+
+	while( *cursor == ' ' || *cursor == '\t' || *cursor == '\n' || *cursor == '\r' ) {
+		cursor++;
+	}
+
+	return cursor;
+
+}
+
+// Which callback an object's keys go to, from the containers around it. 
+// Entity group names and custom fields never reach the key dispatch.
+static KeyContext keyContext( Container* stack, int depth ) {
+
+	if( depth == 1 ) {
+		return KeyContext_Level;
+	}
+
+	if( depth == 3 && stack[1].type == '[' && stack[1].key != NULL && strcmp( stack[1].key, "neighbourLevels" ) == 0 ) {
+		return KeyContext_Neighbor;
+	}
+
+	if( depth == 4 && stack[2].type == '[' && stack[1].key != NULL && strcmp( stack[1].key, "entities" ) == 0 ) {
+		return KeyContext_Entity;
+	}
+
+	return KeyContext_None;
+
+}
+
+// Push the keys of a whole JSON document, name is only used for errors
+static bool scanKeys( const char* name, const char* json, KeyStream* stream ) {
+
+	Container stack[BENCH_MAX_DEPTH] = { 0 };
+	int depth = 0;
+	char* pendingKey = NULL;
+
+	const char* cursor = json;
+	while( *cursor != '\0' ) {
+
+		cursor = skipSpace( cursor );
+
+		switch( *cursor ) {
+
+			case '{':
+			case '[':
+
+				if( depth == BENCH_MAX_DEPTH ) {
+					fprintf( stderr, "%s nests too deep\n", name );
+					return false;
+				}
+
+				stack[depth++] = (Container){ .type = *cursor, .key = pendingKey };
+				pendingKey = NULL;
+				cursor++;
+				break;
+
+			case '}':
+			case ']':
+				depth = depth > 0 ? depth - 1 : 0;
+				cursor++;
+				break;
+
+			case '"': {
+
+				char* value = readString( &cursor );
+				cursor = skipSpace( cursor );
+
+				if( *cursor != ':' || depth == 0 || stack[depth - 1].type != '{' ) {
+					free( value );
+					break;
+				}
+
+				cursor = skipSpace( cursor + 1 );
+				pendingKey = value;
+
+				// Every key is kept until parsing is done, the containers point
+				// at them
+				if( !pushKey( stream, value, keyContext( stack, depth ), *cursor == '{' || *cursor == '[' ) ) {
+					free( value );
+					return false;
+				}
+
+				break;
+
+			}
+
+			case '\0':
+				break;
+
+			default:
+				cursor++;
+				break;
+
+		}
+
+	}
+
+	// Keep only the keys the decoder dispatches
+	size_t kept = 0;
+	for( size_t i = 0; i < stream->count; i++ ) {
+
+		if( stream->keys[i].context == KeyContext_None ) {
+			free( stream->keys[i].key );
+			continue;
+		}
+
+		stream->keys[kept++] = stream->keys[i];
+
+	}
+
+	stream->count = kept;
+
+	return true;
+
+}
+
+static bool readKeys( const char* path, KeyStream* stream ) {
+
+	FILE* file = fopen( path, "rb" );
+	if( file == NULL ) {
+		fprintf( stderr, "Could not open %s\n", path );
+		return false;
+	}
+
+	fseek( file, 0, SEEK_END );
+	long size = ftell( file );
+	fseek( file, 0, SEEK_SET );
+
+	char* json = calloc( size + 1, 1 );
+	size_t read = fread( json, 1, size, file );
+	fclose( file );
+
+	json[read] = '\0';
+
+	bool scanned = scanKeys( path, json, stream );
+	free( json );
+
+	return scanned;
+
+}
+
+// Generating Levels
+
+static void appendJson( JsonBuffer* buffer, const char* fmt, ... ) {
+
+	va_list args;
+
+	va_start( args, fmt );
+	int length = vsnprintf( NULL, 0, fmt, args );
+	va_end( args );
+
+	char* text = prismaticArray->reserve( buffer->text, &buffer->capacity, buffer->length + length + 1, 1 );
+	if( text == NULL ) {
+		return;
+	}
+
+	buffer->text = text;
+
+	va_start( args, fmt );
+	vsnprintf( buffer->text + buffer->length, length + 1, fmt, args );
+	va_end( args );
+
+	buffer->length += length;
+
+}
+
+// A level shaped like an LDtk super-simple export, with entityCount 
+// entities over a few groups, and custom fields on the level and on every 
+// entity
+static void generateLevel( JsonBuffer* json, size_t entityCount ) {
+
+	static const char* groups[] = { "Player", "Enemy", "Coin", "Door", "Spike", "Checkpoint", "Platform", "Sign" };
+	static const char* dirs[] = { "n", "e", "s", "w" };
+	size_t groupCount = sizeof( groups ) / sizeof( groups[0] );
+
+	appendJson( json, "{\n\t\"identifier\": \"Level_Generated\",\n\t\"uniqueIdentifer\": \"00000000-0000-4000-8000-000000000000\",\n" );
+	appendJson( json, "\t\"x\": 0,\n\t\"y\": 0,\n\t\"width\": %zu,\n\t\"height\": 240,\n\t\"bgColor\": \"#696A79\",\n", entityCount * 16 );
+
+	appendJson( json, "\t\"neighbourLevels\": [" );
+	for( size_t i = 0; i < 4; i++ ) {
+		appendJson( json, "%s\n\t\t{ \"levelIid\": \"%08zx-0000-4000-8000-000000000000\", \"dir\": \"%s\" }", i > 0 ? "," : "", i + 1, dirs[i] );
+	}
+	appendJson( json, "\n\t],\n" );
+
+	appendJson( json, "\t\"customFields\": {" );
+	for( size_t i = 0; i < 16; i++ ) {
+		appendJson( json, "%s\n\t\t\"Field_%zu\": %zu", i > 0 ? "," : "", i, i * 7 );
+	}
+	appendJson( json, "\n\t},\n\t\"layers\": [ \"Ground.png\", \"Props.png\" ],\n\t\"entities\": {" );
+
+	for( size_t g = 0; g < groupCount; g++ ) {
+
+		appendJson( json, "%s\n\t\t\"%s\": [", g > 0 ? "," : "", groups[g] );
+
+		bool first = true;
+		for( size_t i = g; i < entityCount; i += groupCount ) {
+
+			appendJson( json, "%s\n\t\t\t{\n\t\t\t\t\"id\": \"%s\",\n\t\t\t\t\"iid\": \"%08zx-d7b0-11ee-b5da-85719b198b7a\",\n", first ? "" : ",", groups[g], i );
+			appendJson( json, "\t\t\t\t\"layer\": \"Entities\",\n\t\t\t\t\"x\": %zu,\n\t\t\t\t\"y\": %zu,\n\t\t\t\t\"width\": 16,\n\t\t\t\t\"height\": 16,\n", i * 16, ( i % 15 ) * 16 );
+			appendJson( json, "\t\t\t\t\"color\": 12470831,\n\t\t\t\t\"customFields\": { \"health\": %zu, \"loot\": \"coin\", \"speed\": 1.5, \"patrol\": [ { \"cx\": %zu, \"cy\": 2 } ] }\n\t\t\t}", i % 5 + 1, i );
+
+			first = false;
+
+		}
+
+		appendJson( json, "\n\t\t]" );
+
+	}
+
+	appendJson( json, "\n\t}\n}\n" );
+
+}
+
+int main( int argc, char** argv ) {
+
+	hostInit( "." );
+
+	KeyStream stream = { 0 };
+	size_t generated = 0;
+	int paths = 0;
+
+	for( int i = 1; i < argc; i++ ) {
+
+		if( strcmp( argv[i], "--entities" ) == 0 && i + 1 < argc ) {
+			generated = strtoul( argv[++i], NULL, 10 );
+			continue;
+		}
+
+		readKeys( argv[i], &stream );
+		paths++;
+
+	}
+
+	if( paths == 0 && generated == 0 ) {
+		readKeys( "Source/assets/maps/Level_0/data.json", &stream );
+	}
+
+	if( generated > 0 ) {
+
+		JsonBuffer json = { 0 };
+		generateLevel( &json, generated );
+
+		if( json.text == NULL || !scanKeys( "generated level", json.text, &stream ) ) {
+			fprintf( stderr, "Could not generate a level with %zu entities\n", generated );
+		}
+
+		prismaticArray->release( json.text, &json.capacity );
+
+	}
+
+	if( stream.count == 0 ) {
+		fprintf( stderr, "No keys to replay, pass data.json paths or run from the repo root\n" );
+		return 1;
+	}
+
+	size_t rounds = BENCH_TARGET_KEYS / stream.count + 1;
+	size_t total = rounds * stream.count;
+
+	for( size_t i = 0; i < stream.count; i++ ) {
+		if( oldDispatch( &stream.keys[i] ) != newDispatch( &stream.keys[i] ) ) {
+			printf( "Dispatch differs for \"%s\"\n", stream.keys[i].key );
+		}
+	}
+
+	long check = 0;
+
+	double start = hostSeconds();
+	for( size_t r = 0; r < rounds; r++ ) {
+		for( size_t i = 0; i < stream.count; i++ ) {
+			check += oldDispatch( &stream.keys[i] );
+		}
+	}
+	double chained = hostSeconds() - start;
+
+	start = hostSeconds();
+	for( size_t r = 0; r < rounds; r++ ) {
+		for( size_t i = 0; i < stream.count; i++ ) {
+			check -= newDispatch( &stream.keys[i] );
+		}
+	}
+	double matched = hostSeconds() - start;
+
+	printf(
+		"%zu keys x %zu: equals chains %6.1f ns/key  matchKey %6.1f ns/key  %4.1fx%s\n",
+		stream.count,
+		rounds,
+		chained * 1e9 / total,
+		matched * 1e9 / total,
+		chained / matched,
+		check == 0 ? "" : "  MISMATCH"
+	);
+
+	for( size_t i = 0; i < stream.count; i++ ) {
+		free( stream.keys[i].key );
+	}
+
+	prismaticArray->release( stream.keys, &stream.capacity );
+
+	return 0;
+
+}
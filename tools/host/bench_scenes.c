@@ -0,0 +1,103 @@
+// bench_scenes.c
+//
+// Looks Scenes up by name through the SceneManager's hash index and through
+// the linear strcmp walk it replaced, at 10, 100 and 1000 Scenes.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "host.h"
+
+#define BENCH_LOOKUPS 2000000
+#define BENCH_NAME_SIZE 32
+
+// How SceneManager found a Scene by name before the index
+static Scene* linearGet( SceneManager* sceneManager, const char* name ) {
+
+	for( int i = 0; i < sceneManager->totalScenes; i++ ) {
+		if( strcmp( sceneManager->scenes[i]->name, name ) == 0 ) {
+			return sceneManager->scenes[i];
+		}
+	}
+
+	return NULL;
+
+}
+
+static uint32_t nextRandom( uint32_t* state ) {
+
+	*state ^= *state << 13;
+	*state ^= *state >> 17;
+	*state ^= *state << 5;
+
+	return *state;
+
+}
+
+static void benchScenes( int sceneCount ) {
+
+	char ( *names )[BENCH_NAME_SIZE] = calloc( sceneCount, BENCH_NAME_SIZE );
+	char ( *keys )[BENCH_NAME_SIZE] = calloc( sceneCount, BENCH_NAME_SIZE );
+	size_t* order = calloc( BENCH_LOOKUPS, sizeof( size_t ) );
+
+	// Names like the ones games use, sharing a prefix so strcmp does work
+	for( int i = 0; i < sceneCount; i++ ) {
+		snprintf( names[i], BENCH_NAME_SIZE, "scene_room_%04d", i );
+		memcpy( keys[i], names[i], BENCH_NAME_SIZE );
+	}
+
+	SceneManager* sceneManager = prismaticSceneManager->new( prismaticScene->new( names[0] ) );
+	for( int i = 1; i < sceneCount; i++ ) {
+		prismaticSceneManager->add( sceneManager, prismaticScene->new( names[i] ) );
+	}
+
+	// Scenes keep the name pointer they are given, so look up copies to make
+	// both sides compare strings
+	uint32_t state = 0x9E3779B9;
+	for( size_t i = 0; i < BENCH_LOOKUPS; i++ ) {
+		order[i] = nextRandom( &state ) % sceneCount;
+	}
+
+	uintptr_t check = 0;
+
+	double start = hostSeconds();
+	for( size_t i = 0; i < BENCH_LOOKUPS; i++ ) {
+		check += (uintptr_t)linearGet( sceneManager, keys[order[i]] );
+	}
+	double linear = hostSeconds() - start;
+
+	start = hostSeconds();
+	for( size_t i = 0; i < BENCH_LOOKUPS; i++ ) {
+		check -= (uintptr_t)prismaticSceneManager->get( sceneManager, keys[order[i]] );
+	}
+	double indexed = hostSeconds() - start;
+
+	printf(
+		"%5d scenes: linear %8.1f ns  index %6.1f ns  %6.1fx%s\n",
+		sceneCount,
+		linear * 1e9 / BENCH_LOOKUPS,
+		indexed * 1e9 / BENCH_LOOKUPS,
+		linear / indexed,
+		check == 0 ? "" : "  MISMATCH"
+	);
+
+	prismaticSceneManager->delete( sceneManager );
+	free( order );
+	free( keys );
+	free( names );
+
+}
+
+int main( void ) {
+
+	hostInit( "." );
+
+	int sceneCounts[] = { 10, 100, 1000 };
+	for( size_t i = 0; i < sizeof( sceneCounts ) / sizeof( sceneCounts[0] ); i++ ) {
+		benchScenes( sceneCounts[i] );
+	}
+
+	return 0;
+
+}
@@ -0,0 +1,41 @@
+#!/bin/sh
+#
+# Build a host benchmark against the engine and the mocked Playdate API.
+#
+#     tools/host/build.sh bench_scenes
+#     tools/host/_build/bench_scenes
+#
+# Engine sources a benchmark #includes, to reach their static functions, are
+# left out of the link. Set CC or CFLAGS to override the compiler and flags.
+
+set -e
+
+if [ $# -ne 1 ]; then
+	echo "usage: $0 <benchmark>" >&2
+	exit 1
+fi
+
+HOST=$(cd "$(dirname "$0")" && pwd)
+ROOT=$(cd "$HOST/../.." && pwd)
+BENCH="$HOST/$1.c"
+OUT="$HOST/_build"
+
+CC=${CC:-cc}
+CFLAGS=${CFLAGS:--std=c11 -O2 -D_GNU_SOURCE -Wall -Wextra}
+
+INCLUDED=$(sed -n 's|^#include "\(.*\.c\)"|\1|p' "$BENCH" | while read -r src; do
+	(cd "$HOST" && realpath "$src")
+done)
+
+SOURCES=""
+for src in $(find "$ROOT/src/prismatic" -name '*.c' | sort); do
+	if ! echo "$INCLUDED" | grep -qx "$src"; then
+		SOURCES="$SOURCES $src"
+	fi
+done
+
+mkdir -p "$OUT"
+
+# Engine sources lean on prismatic.h being included first
+$CC $CFLAGS -I"$HOST" -I"$ROOT/src/prismatic" -include "$ROOT/src/prismatic/prismatic.h" \
+	$SOURCES "$HOST/mock.c" "$BENCH" -o "$OUT/$1" -lm
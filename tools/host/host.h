@@ -0,0 +1,22 @@
+// host.h
+//
+// Runs engine code on a desktop machine for benchmarks, against the mocked
+// Playdate API in mock.c. Build with tools/host/build.sh.
+
+#ifndef HOST_H
+#define HOST_H
+
+#include "prismatic.h"
+
+// Point the engine's globals at the mocked Playdate API
+//
+// ----
+//
+// const char* root - The directory files are opened from, like the Source
+// directory on device
+PlaydateAPI* hostInit( const char* root );
+
+// Seconds on a monotonic clock
+double hostSeconds( void );
+
+#endif
@@ -0,0 +1,311 @@
+// mock.c
+//
+// Just enough of the Playdate API to run the engine on a desktop machine.
+// Sprites and bitmaps only remember what benchmarks might check, drawing does
+// nothing, and any call not set up below is NULL.
+
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "host.h"
+
+struct LCDSprite {
+	float x;
+	float y;
+	PDRect bounds;
+	LCDBitmap* image;
+	uint8_t tag;
+	int visible;
+	int added;
+};
+
+struct LCDBitmap {
+	int width;
+	int height;
+};
+
+static const char* fileRoot = ".";
+static double elapsedStart = 0.0;
+
+static void* hostRealloc( void* ptr, size_t size ) {
+
+	if( size == 0 ) {
+		free( ptr );
+		return NULL;
+	}
+
+	return realloc( ptr, size );
+
+}
+
+static void hostLog( const char* fmt, ... ) {
+
+	va_list args;
+	va_start( args, fmt );
+	vprintf( fmt, args );
+	va_end( args );
+
+	printf( "\n" );
+
+}
+
+static void hostError( const char* fmt, ... ) {
+
+	va_list args;
+	va_start( args, fmt );
+	vfprintf( stderr, fmt, args );
+	va_end( args );
+
+	fprintf( stderr, "\n" );
+
+}
+
+double hostSeconds( void ) {
+
+	struct timespec now;
+	clock_gettime( CLOCK_MONOTONIC, &now );
+
+	return (double)now.tv_sec + (double)now.tv_nsec / 1e9;
+
+}
+
+static unsigned int hostMilliseconds( void ) {
+	return (unsigned int)( hostSeconds() * 1000.0 );
+}
+
+static float hostElapsed( void ) {
+	return (float)( hostSeconds() - elapsedStart );
+}
+
+static void hostResetElapsed( void ) {
+	elapsedStart = hostSeconds();
+}
+
+static float hostRefreshRate( void ) {
+	return 30.0f;
+}
+
+// Sprites
+
+static LCDSprite* hostNewSprite( void ) {
+	return calloc( 1, sizeof( LCDSprite ) );
+}
+
+static void hostFreeSprite( LCDSprite* sprite ) {
+	free( sprite );
+}
+
+static void hostAddSprite( LCDSprite* sprite ) {
+	sprite->added = 1;
+}
+
+static void hostRemoveSprite( LCDSprite* sprite ) {
+	sprite->added = 0;
+}
+
+static void hostMoveTo( LCDSprite* sprite, float x, float y ) {
+	sprite->x = x;
+	sprite->y = y;
+}
+
+static void hostGetPosition( LCDSprite* sprite, float* x, float* y ) {
+	*x = sprite->x;
+	*y = sprite->y;
+}
+
+static void hostSetBounds( LCDSprite* sprite, PDRect bounds ) {
+	sprite->bounds = bounds;
+}
+
+static void hostSetImage( LCDSprite* sprite, LCDBitmap* image, LCDBitmapFlip flip ) {
+
+	(void)flip;
+
+	sprite->image = image;
+
+}
+
+static LCDBitmap* hostGetImage( LCDSprite* sprite ) {
+	return sprite->image;
+}
+
+static void hostSetVisible( LCDSprite* sprite, int flag ) {
+	sprite->visible = flag;
+}
+
+static void hostSetTag( LCDSprite* sprite, uint8_t tag ) {
+	sprite->tag = tag;
+}
+
+// Nothing is drawn or collided, so these only take their arguments
+static void hostSetZIndex( LCDSprite* sprite, int16_t zIndex ) { (void)sprite; (void)zIndex; }
+static void hostSetCenter( LCDSprite* sprite, float x, float y ) { (void)sprite; (void)x; (void)y; }
+static void hostSetSize( LCDSprite* sprite, float width, float height ) { (void)sprite; (void)width; (void)height; }
+static void hostSetCollisionsEnabled( LCDSprite* sprite, int flag ) { (void)sprite; (void)flag; }
+static void hostSetCollideRect( LCDSprite* sprite, PDRect rect ) { (void)sprite; (void)rect; }
+static void hostMarkDirty( LCDSprite* sprite ) { (void)sprite; }
+
+// Graphics
+
+static LCDBitmap* hostLoadBitmap( const char* path, const char** err ) {
+
+	(void)path;
+	(void)err;
+
+	LCDBitmap* bitmap = calloc( 1, sizeof( LCDBitmap ) );
+	if( bitmap != NULL ) {
+		bitmap->width = 16;
+		bitmap->height = 16;
+	}
+
+	return bitmap;
+
+}
+
+static void hostFreeBitmap( LCDBitmap* bitmap ) {
+	free( bitmap );
+}
+
+static void hostGetBitmapData( LCDBitmap* bitmap, int* width, int* height, int* rowbytes, uint8_t** mask, uint8_t** data ) {
+
+	if( width != NULL ) *width = bitmap->width;
+	if( height != NULL ) *height = bitmap->height;
+	if( rowbytes != NULL ) *rowbytes = ( bitmap->width + 7 ) / 8;
+	if( mask != NULL ) *mask = NULL;
+	if( data != NULL ) *data = NULL;
+
+}
+
+static void hostClear( LCDColor color ) { (void)color; }
+static void hostDrawBitmap( LCDBitmap* bitmap, int x, int y, LCDBitmapFlip flip ) { (void)bitmap; (void)x; (void)y; (void)flip; }
+static void hostPushContext( LCDBitmap* target ) { (void)target; }
+static void hostPopContext( void ) {}
+
+// Files, opened relative to fileRoot
+
+static SDFile* hostOpen( const char* name, FileOptions mode ) {
+
+	char path[1024];
+	snprintf( path, sizeof( path ), "%s/%s", fileRoot, name );
+
+	return (SDFile*)fopen( path, ( mode & kFileWrite ) ? "wb" : "rb" );
+
+}
+
+static int hostClose( SDFile* file ) {
+	return fclose( (FILE*)file );
+}
+
+static int hostRead( SDFile* file, void* buf, unsigned int len ) {
+	return (int)fread( buf, 1, len, (FILE*)file );
+}
+
+static int hostSeek( SDFile* file, int pos, int whence ) {
+	return fseek( (FILE*)file, pos, whence );
+}
+
+static int hostTell( SDFile* file ) {
+	return (int)ftell( (FILE*)file );
+}
+
+static int hostDisplayWidth( void ) {
+	return LCD_COLUMNS;
+}
+
+static int hostDisplayHeight( void ) {
+	return LCD_ROWS;
+}
+
+static struct playdate_sys hostSys = {
+	.realloc = hostRealloc,
+	.logToConsole = hostLog,
+	.error = hostError,
+	.getCurrentTimeMilliseconds = hostMilliseconds,
+	.getElapsedTime = hostElapsed,
+	.resetElapsedTime = hostResetElapsed,
+	.getRefreshRate = hostRefreshRate,
+};
+
+static struct playdate_sprite hostSprite = {
+	.newSprite = hostNewSprite,
+	.freeSprite = hostFreeSprite,
+	.addSprite = hostAddSprite,
+	.removeSprite = hostRemoveSprite,
+	.moveTo = hostMoveTo,
+	.getPosition = hostGetPosition,
+	.setBounds = hostSetBounds,
+	.setImage = hostSetImage,
+	.getImage = hostGetImage,
+	.setVisible = hostSetVisible,
+	.setTag = hostSetTag,
+	.setZIndex = hostSetZIndex,
+	.setCenter = hostSetCenter,
+	.setSize = hostSetSize,
+	.setCollisionsEnabled = hostSetCollisionsEnabled,
+	.setCollideRect = hostSetCollideRect,
+	.markDirty = hostMarkDirty,
+};
+
+static struct playdate_graphics hostGraphics = {
+	.loadBitmap = hostLoadBitmap,
+	.freeBitmap = hostFreeBitmap,
+	.getBitmapData = hostGetBitmapData,
+	.clear = hostClear,
+	.drawBitmap = hostDrawBitmap,
+	.pushContext = hostPushContext,
+	.popContext = hostPopContext,
+};
+
+static struct playdate_file hostFile = {
+	.open = hostOpen,
+	.close = hostClose,
+	.read = hostRead,
+	.seek = hostSeek,
+	.tell = hostTell,
+};
+
+static struct playdate_display hostDisplay = {
+	.getWidth = hostDisplayWidth,
+	.getHeight = hostDisplayHeight,
+	.getRefreshRate = hostRefreshRate,
+};
+
+static struct playdate_json hostJson = { 0 };
+static struct playdate_sound hostSound = { 0 };
+
+static PlaydateAPI hostApi = {
+	.system = &hostSys,
+	.file = &hostFile,
+	.graphics = &hostGraphics,
+	.sprite = &hostSprite,
+	.display = &hostDisplay,
+	.sound = &hostSound,
+	.json = &hostJson,
+};
+
+PlaydateAPI* hostInit( const char* root ) {
+
+	fileRoot = root;
+	hostResetElapsed();
+
+	pd = &hostApi;
+	sys = hostApi.system;
+	sprites = hostApi.sprite;
+	graphics = hostApi.graphics;
+	sound = hostApi.sound;
+
+	return &hostApi;
+
+}
+
+// prismatic.c creates the game in initEngine, which benchmarks never call
+Game* newGame( void ) {
+
+	static Game game;
+
+	return &game;
+
+}
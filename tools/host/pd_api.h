@@ -0,0 +1,200 @@
+// The parts of the Playdate C API the engine uses, declared for host builds.
+// Layouts follow the SDK only as far as the engine needs, see mock.c.
+#ifndef PD_STUB_H
+#define PD_STUB_H
+#include <stdint.h>
+#include <stddef.h>
+#include <stdarg.h>
+#include <stdbool.h>
+
+typedef struct LCDBitmap LCDBitmap;
+typedef struct LCDBitmapTable LCDBitmapTable;
+typedef struct LCDSprite LCDSprite;
+typedef struct LCDFont LCDFont;
+typedef struct SDFile SDFile;
+typedef struct FilePlayer FilePlayer;
+typedef uint8_t LCDPattern[16];
+typedef uintptr_t LCDColor;
+typedef enum { kColorBlack, kColorWhite, kColorClear, kColorXOR } LCDSolidColor;
+typedef enum { kBitmapUnflipped, kBitmapFlippedX, kBitmapFlippedY, kBitmapFlippedXY } LCDBitmapFlip;
+typedef enum { kDrawModeCopy, kDrawModeWhiteTransparent, kDrawModeBlackTransparent, kDrawModeFillWhite, kDrawModeFillBlack, kDrawModeXOR, kDrawModeNXOR, kDrawModeInverted } LCDBitmapDrawMode;
+typedef enum { kASCIIEncoding, kUTF8Encoding, k16BitLEEncoding } PDStringEncoding;
+typedef enum { kButtonLeft=1, kButtonRight=2, kButtonUp=4, kButtonDown=8, kButtonB=16, kButtonA=32 } PDButtons;
+typedef enum { kEventInit, kEventInitLua, kEventLock, kEventUnlock, kEventPause, kEventResume, kEventTerminate, kEventKeyPressed, kEventKeyReleased, kEventLowPower } PDSystemEvent;
+typedef enum { kFileRead=1, kFileReadData=2, kFileWrite=4, kFileAppend=8 } FileOptions;
+#define SEEK_SET 0
+#define SEEK_CUR 1
+#define SEEK_END 2
+#define LCD_ROWS 240
+#define LCD_COLUMNS 400
+#define LCD_ROWSIZE 52
+
+typedef struct { float x, y, width, height; } PDRect;
+static inline PDRect PDRectMake(float x, float y, float w, float h) { PDRect r = {x,y,w,h}; return r; }
+typedef struct { int left, right, top, bottom; } LCDRect;
+typedef struct { float x, y; } CollisionPoint;
+typedef struct { int x, y; } CollisionVector;
+typedef enum { kCollisionTypeSlide, kCollisionTypeFreeze, kCollisionTypeOverlap, kCollisionTypeBounce } SpriteCollisionResponseType;
+typedef struct SpriteCollisionInfo { LCDSprite* sprite; LCDSprite* other; SpriteCollisionResponseType responseType; uint8_t overlaps; float ti; CollisionPoint move; CollisionVector normal; CollisionPoint touch; PDRect spriteRect; PDRect otherRect; } SpriteCollisionInfo;
+typedef void LCDSpriteDrawFunction(LCDSprite* sprite, PDRect bounds, PDRect drawrect);
+typedef void LCDSpriteUpdateFunction(LCDSprite* sprite);
+
+struct playdate_graphics {
+	void (*clear)(LCDColor color);
+	void (*setDrawMode)(LCDBitmapDrawMode mode);
+	void (*drawBitmap)(LCDBitmap* bitmap, int x, int y, LCDBitmapFlip flip);
+	void (*fillRect)(int x, int y, int width, int height, LCDColor color);
+	int (*drawText)(const void* text, size_t len, PDStringEncoding encoding, int x, int y);
+	LCDBitmap* (*newBitmap)(int width, int height, LCDColor bgcolor);
+	void (*freeBitmap)(LCDBitmap*);
+	LCDBitmap* (*loadBitmap)(const char* path, const char** outerr);
+	LCDBitmap* (*copyBitmap)(LCDBitmap* bitmap);
+	void (*getBitmapData)(LCDBitmap* bitmap, int* width, int* height, int* rowbytes, uint8_t** mask, uint8_t** data);
+	void (*clearBitmap)(LCDBitmap* bitmap, LCDColor bgcolor);
+	LCDBitmapTable* (*newBitmapTable)(int count, int width, int height);
+	void (*freeBitmapTable)(LCDBitmapTable* table);
+	LCDBitmapTable* (*loadBitmapTable)(const char* path, const char** outerr);
+	LCDBitmap* (*getTableBitmap)(LCDBitmapTable* table, int idx);
+	void (*getBitmapTableInfo)(LCDBitmapTable* table, int* count, int* width);
+	LCDFont* (*loadFont)(const char* path, const char** outErr);
+	void (*setFont)(LCDFont* font);
+	int (*getTextWidth)(LCDFont* font, const void* text, size_t len, PDStringEncoding encoding, int tracking);
+	uint8_t (*getFontHeight)(LCDFont* font);
+	int (*getTextTracking)(void);
+	void (*pushContext)(LCDBitmap* target);
+	void (*setClipRect)(int x, int y, int width, int height);
+	void (*clearClipRect)(void);
+	void (*popContext)(void);
+	void (*setDrawOffset)(int dx, int dy);
+	void (*getDrawOffset)(int* dx, int* dy);
+	int (*setBitmapMask)(LCDBitmap* bitmap, LCDBitmap* mask);
+	uint8_t* (*getFrame)(void);
+	void (*markUpdatedRows)(int start, int end);
+	LCDBitmap* (*getDisplayBufferBitmap)(void);
+	LCDBitmap* (*getBitmapMask)(LCDBitmap* bitmap);
+};
+
+struct playdate_sprite {
+	void (*setAlwaysRedraw)(int flag);
+	void (*drawSprites)(void);
+	void (*updateAndDrawSprites)(void);
+	LCDSprite* (*newSprite)(void);
+	void (*freeSprite)(LCDSprite* sprite);
+	LCDSprite* (*copy)(LCDSprite* sprite);
+	void (*addSprite)(LCDSprite* sprite);
+	void (*removeSprite)(LCDSprite* sprite);
+	void (*removeSprites)(LCDSprite** sprites, int count);
+	void (*removeAllSprites)(void);
+	int (*getSpriteCount)(void);
+	void (*setBounds)(LCDSprite* sprite, PDRect bounds);
+	PDRect (*getBounds)(LCDSprite* sprite);
+	void (*moveTo)(LCDSprite* sprite, float x, float y);
+	void (*moveBy)(LCDSprite* sprite, float dx, float dy);
+	void (*setImage)(LCDSprite* sprite, LCDBitmap* image, LCDBitmapFlip flip);
+	LCDBitmap* (*getImage)(LCDSprite* sprite);
+	void (*setSize)(LCDSprite* s, float width, float height);
+	void (*setZIndex)(LCDSprite* sprite, int16_t zIndex);
+	int16_t (*getZIndex)(LCDSprite* sprite);
+	void (*setDrawMode)(LCDSprite* sprite, LCDBitmapDrawMode mode);
+	void (*setImageFlip)(LCDSprite* sprite, LCDBitmapFlip flip);
+	void (*setUpdatesEnabled)(LCDSprite* sprite, int flag);
+	int (*updatesEnabled)(LCDSprite* sprite);
+	void (*setCollisionsEnabled)(LCDSprite* sprite, int flag);
+	int (*collisionsEnabled)(LCDSprite* sprite);
+	void (*setVisible)(LCDSprite* sprite, int flag);
+	int (*isVisible)(LCDSprite* sprite);
+	void (*setOpaque)(LCDSprite* sprite, int flag);
+	void (*markDirty)(LCDSprite* sprite);
+	void (*setTag)(LCDSprite* sprite, uint8_t tag);
+	uint8_t (*getTag)(LCDSprite* sprite);
+	void (*setIgnoresDrawOffset)(LCDSprite* sprite, int flag);
+	void (*setUpdateFunction)(LCDSprite* sprite, LCDSpriteUpdateFunction* func);
+	void (*setDrawFunction)(LCDSprite* sprite, LCDSpriteDrawFunction* func);
+	void (*getPosition)(LCDSprite* sprite, float* x, float* y);
+	void (*resetCollisionWorld)(void);
+	void (*setCollideRect)(LCDSprite* sprite, PDRect collideRect);
+	PDRect (*getCollideRect)(LCDSprite* sprite);
+	void (*clearCollideRect)(LCDSprite* sprite);
+	SpriteCollisionInfo* (*moveWithCollisions)(LCDSprite* sprite, float goalX, float goalY, float* actualX, float* actualY, int* len);
+	void (*setUserdata)(LCDSprite* sprite, void* userdata);
+	void* (*getUserdata)(LCDSprite* sprite);
+	void (*setCenter)(LCDSprite* s, float x, float y);
+};
+
+struct playdate_sys {
+	void* (*realloc)(void* ptr, size_t size);
+	int (*formatString)(char **ret, const char *fmt, ...);
+	void (*logToConsole)(const char* fmt, ...);
+	void (*error)(const char* fmt, ...);
+	void (*drawFPS)(int x, int y);
+	void (*setUpdateCallback)(int (*update)(void* userdata), void* userdata);
+	void (*getButtonState)(PDButtons* current, PDButtons* pushed, PDButtons* released);
+	unsigned int (*getCurrentTimeMilliseconds)(void);
+	unsigned int (*getSecondsSinceEpoch)(unsigned int *milliseconds);
+	float (*getElapsedTime)(void);
+	void (*resetElapsedTime)(void);
+	void (*setRefreshRate)(float rate);
+	float (*getRefreshRate)(void);
+};
+
+struct playdate_display {
+	int (*getWidth)(void);
+	int (*getHeight)(void);
+	void (*setRefreshRate)(float rate);
+	float (*getRefreshRate)(void);
+};
+
+struct playdate_file {
+	const char* (*geterr)(void);
+	SDFile* (*open)(const char* name, FileOptions mode);
+	int (*close)(SDFile* file);
+	int (*read)(SDFile* file, void* buf, unsigned int len);
+	int (*write)(SDFile* file, const void* buf, unsigned int len);
+	int (*seek)(SDFile* file, int pos, int whence);
+	int (*tell)(SDFile* file);
+};
+
+typedef enum { kJSONNull, kJSONTrue, kJSONFalse, kJSONInteger, kJSONFloat, kJSONString, kJSONArray, kJSONTable } json_value_type;
+typedef struct { char type; union { int intval; float floatval; char* stringval; void* arrayval; void* tableval; } data; } json_value;
+static inline int json_intValue(json_value value) { return value.data.intval; }
+static inline float json_floatValue(json_value value) { return value.data.floatval; }
+static inline int json_boolValue(json_value value) { return value.type == kJSONTrue; }
+static inline char* json_stringValue(json_value value) { return value.data.stringval; }
+typedef struct json_decoder json_decoder;
+struct json_decoder {
+	void (*decodeError)(json_decoder* decoder, const char* error, int linenum);
+	void (*willDecodeSublist)(json_decoder* decoder, const char* name, json_value_type type);
+	int (*shouldDecodeTableValueForKey)(json_decoder* decoder, const char* key);
+	void (*didDecodeTableValue)(json_decoder* decoder, const char* key, json_value value);
+	int (*shouldDecodeArrayValueAtIndex)(json_decoder* decoder, int pos);
+	void (*didDecodeArrayValue)(json_decoder* decoder, int pos, json_value value);
+	void* (*didDecodeSublist)(json_decoder* decoder, const char* name, json_value_type type);
+	void* userdata;
+	int returnString;
+	const char* path;
+};
+typedef struct { int (*read)(void* userdata, uint8_t* buf, int bufsize); void* userdata; } json_reader;
+struct playdate_json {
+	int (*decode)(struct json_decoder* functions, json_reader reader, json_value* outval);
+	int (*decodeString)(struct json_decoder* functions, const char* jsonString, json_value* outval);
+};
+
+struct playdate_sound_fileplayer {
+	FilePlayer* (*newPlayer)(void);
+	void (*freePlayer)(FilePlayer* player);
+	int (*loadIntoPlayer)(FilePlayer* player, const char* path);
+	int (*play)(FilePlayer* player, int repeat);
+};
+struct playdate_sound { const struct playdate_sound_fileplayer* fileplayer; };
+
+typedef struct PlaydateAPI {
+	const struct playdate_sys* system;
+	const struct playdate_file* file;
+	const struct playdate_graphics* graphics;
+	const struct playdate_sprite* sprite;
+	const struct playdate_display* display;
+	const struct playdate_sound* sound;
+	const struct playdate_json* json;
+} PlaydateAPI;
+
+#endif
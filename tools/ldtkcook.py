@@ -0,0 +1,185 @@
+#!/usr/bin/env python3
+"""Cook an LDtk super-simple export directory into a binary map.
+
+The result is loaded by prismaticTileMap->newFromBinary with a single read,
+without decoding any JSON or csv on the device.
+
+    python3 tools/ldtkcook.py Source/assets/maps/Level_0 --tile-size 16
+
+Every csv in the directory is cooked as a collision layer unless --collision
+names them. Custom fields are not cooked.
+
+Layout, all values are little endian uint32 unless noted:
+
+    header       magic "PLDK", version, id, iid, worldX, worldY, width,
+                 height, tileSize, gridWidth, gridHeight, then a count and an
+                 offset for each of layers, neighbours, entity groups,
+                 entities and IntGrids
+    layers       filename, zIndex
+    neighbours   levelIid, dir
+    groups       type, first entity, entity count. Groups cover the
+                 entities in order, each entity in exactly one group.
+    entities     id, iid, layer, x, y, width, height (int32)
+    IntGrids     name, data offset
+    IntGrid data gridHeight rows of (gridWidth + 31) / 32 words, cell x of a
+                 row is bit x % 32 of word x / 32, set for any non-zero value.
+                 Then one uint8 value per cell, row by row, padded to a
+                 whole word
+    strings      NUL terminated, referenced by offset from the start of the
+                 file, offset 0 is NULL. The file always ends with a NUL.
+"""
+
+import argparse
+import json
+import os
+import struct
+import sys
+
+MAGIC = b"PLDK"
+VERSION = 2
+HEADER_WORDS = 21
+
+
+class Strings:
+
+    def __init__(self):
+        self.data = bytearray()
+        self.offsets = {}
+
+    def add(self, value):
+        if value is None:
+            return None
+        if value not in self.offsets:
+            self.offsets[value] = len(self.data)
+            self.data += value.encode("utf-8") + b"\0"
+        return self.offsets[value]
+
+
+def read_grid(path, width, height):
+
+    with open(path, newline="") as f:
+        values = [int(v) for v in f.read().replace("\r", "").replace("\n", "").split(",") if v.strip()]
+
+    if len(values) < width * height:
+        sys.exit(f"{path}: expected {width * height} values, found {len(values)}")
+
+    if any(v > 255 for v in values):
+        sys.exit(f"{path}: IntGrid values must be 255 or less")
+
+    words_per_row = (width + 31) // 32
+    data = bytearray()
+    for y in range(height):
+        row = [0] * words_per_row
+        for x in range(width):
+            if values[y * width + x] != 0:
+                row[x // 32] |= 1 << (x % 32)
+        data += struct.pack(f"<{words_per_row}I", *row)
+
+    data += bytes(values[:width * height])
+    data += bytes(-len(data) % 4)
+
+    return bytes(data)
+
+
+def cook(directory, tile_size, collision):
+
+    with open(os.path.join(directory, "data.json")) as f:
+        level = json.load(f)
+
+    width = level.get("width", 0)
+    height = level.get("height", 0)
+    grid_width = width // tile_size
+    grid_height = height // tile_size
+
+    if collision is None:
+        collision = sorted(name[:-4] for name in os.listdir(directory) if name.endswith(".csv"))
+
+    layers = [(name, z) for z, name in enumerate(level.get("layers", []))]
+    neighbours = [(n.get("levelIid"), n.get("dir")) for n in level.get("neighbourLevels", [])]
+
+    groups = []
+    entities = []
+    for group_type, group in level.get("entities", {}).items():
+        groups.append((group_type, len(entities), len(group)))
+        for e in group:
+            entities.append((e.get("id"), e.get("iid"), e.get("layer"), e.get("x", 0), e.get("y", 0), e.get("width", 0), e.get("height", 0)))
+
+    grids = [(name, read_grid(os.path.join(directory, name + ".csv"), grid_width, grid_height)) for name in collision]
+
+    # Offsets of every section, the strings come last
+    layers_offset = HEADER_WORDS * 4
+    neighbours_offset = layers_offset + len(layers) * 8
+    groups_offset = neighbours_offset + len(neighbours) * 8
+    entities_offset = groups_offset + len(groups) * 12
+    grids_offset = entities_offset + len(entities) * 28
+    data_offset = grids_offset + len(grids) * 8
+    strings_offset = data_offset + sum(len(data) for _, data in grids)
+
+    strings = Strings()
+
+    def ref(value):
+        offset = strings.add(value)
+        return 0 if offset is None else strings_offset + offset
+
+    out = bytearray()
+    out += MAGIC
+    out += struct.pack(
+        "<IIIiiiiIIIIIIIIIIIII",
+        VERSION, ref(level.get("identifier")), ref(level.get("uniqueIdentifer")),
+        level.get("x", 0), level.get("y", 0), width, height,
+        tile_size, grid_width, grid_height,
+        len(layers), layers_offset,
+        len(neighbours), neighbours_offset,
+        len(groups), groups_offset,
+        len(entities), entities_offset,
+        len(grids), grids_offset,
+    )
+
+    for name, z in layers:
+        out += struct.pack("<Ii", ref(name), z)
+
+    for level_iid, direction in neighbours:
+        out += struct.pack("<II", ref(level_iid), ref(direction))
+
+    for group_type, first, count in groups:
+        out += struct.pack("<III", ref(group_type), first, count)
+
+    for id, iid, layer, x, y, w, h in entities:
+        out += struct.pack("<IIIiiii", ref(id), ref(iid), ref(layer), x, y, w, h)
+
+    offset = data_offset
+    for name, data in grids:
+        out += struct.pack("<II", ref(name), offset)
+        offset += len(data)
+
+    for _, data in grids:
+        out += data
+
+    out += strings.data
+    if not strings.data:
+        out += b"\0"
+
+    return bytes(out)
+
+
+def main():
+
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("directory", help="LDtk super-simple export directory of one level")
+    parser.add_argument("-o", "--output", help="binary map to write, defaults to data.bin in the directory")
+    parser.add_argument("--tile-size", type=int, default=16, help="size of a tile in pixels, defaults to 16")
+    parser.add_argument("--collision", help="comma separated csv names to cook, defaults to every csv")
+    args = parser.parse_args()
+
+    collision = args.collision.split(",") if args.collision else None
+    blob = cook(args.directory, args.tile_size, collision)
+
+    output = args.output or os.path.join(args.directory, "data.bin")
+    with open(output, "wb") as f:
+        f.write(blob)
+
+    print(f"{output}: {len(blob)} bytes")
+
+
+if __name__ == "__main__":
+    main()